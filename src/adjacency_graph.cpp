@@ -16,24 +16,29 @@
 
 #include <adjacency_graph.hpp>
 
+#include <algorithm>
 #include <cmath>
 
 #include <string>
 
+#include <stats.hpp>
+
 namespace n1graph {
 
 AdjacencyGraph::AdjacencyGraph() :
-		graph_type_(GraphType::UNDIRECTED) {
+		graph_type_(GraphType::UNDIRECTED), quantization_scale_(1) {
 
 }
 
-AdjacencyGraph::AdjacencyGraph(int n, GraphType directed, float default_value) {
+AdjacencyGraph::AdjacencyGraph(int n, GraphType directed, float default_value) :
+		quantization_scale_(1) {
 	Initialize(n, directed, default_value);
 }
 
 void AdjacencyGraph::AddEdge(int source, int target) {
 	CHECK_LT(source, location_.size());
 	CHECK_LT(target, location_.size());
+	CHECK(!quantized()) << "The edges of a quantized graph are fixed.";
 	adjacency_(source, target) = 1;
 	if (graph_type_ == UNDIRECTED)
 		adjacency_(target, source) = 1;
@@ -42,6 +47,7 @@ void AdjacencyGraph::AddEdge(int source, int target) {
 void AdjacencyGraph::AddWeightedEdge(int source, int target, float weight) {
 	CHECK_LT(source, location_.size());
 	CHECK_LT(target, location_.size());
+	CHECK(!quantized()) << "The edges of a quantized graph are fixed.";
 	adjacency_(source, target) = weight;
 	if (graph_type_ == UNDIRECTED)
 		adjacency_(target, source) = weight;
@@ -50,17 +56,79 @@ void AdjacencyGraph::AddWeightedEdge(int source, int target, float weight) {
 void AdjacencyGraph::AddEuclideanWeightedEdge(int source, int target) {
 	CHECK_LT(source, location_.size());
 	CHECK_LT(target, location_.size());
+	CHECK(!quantized()) << "The edges of a quantized graph are fixed.";
 	adjacency_(source, target) = (location_[source] - location_[target]).Norm();
 	if (graph_type_ == UNDIRECTED)
 		adjacency_(target, source) = adjacency_(source, target);
 }
 
+int AdjacencyGraph::AddEuclideanNode(const Vector<float>& location) {
+	CHECK(!quantized()) << "The edges of a quantized graph are fixed.";
+	int n = adjacency_.rows();
+	Matrix<float> adjacency(n + 1, n + 1, 1, 0);
+	for (int i = 0; i < n; ++i) {
+		for (int j = 0; j < n; ++j) {
+			adjacency(i, j) = adjacency_(i, j);
+		}
+	}
+	adjacency_ = adjacency;
+	location_.push_back(location);
+	for (int i = 0; i < n; ++i) {
+		AddEuclideanWeightedEdge(i, n);
+		if (graph_type_ == GraphType::DIRECTED)
+			AddEuclideanWeightedEdge(n, i);
+	}
+	return n;
+}
+
+void AdjacencyGraph::RemoveNode(int node) {
+	CHECK(!quantized()) << "The edges of a quantized graph are fixed.";
+	int n = adjacency_.rows();
+	CHECK_GE(node, 0);
+	CHECK_LT(node, n);
+	CHECK_GT(n, 1);
+	Matrix<float> adjacency(n - 1, n - 1, 1, 0);
+	for (int i = 0; i < n - 1; ++i) {
+		int row = i < node ? i : i + 1;
+		for (int j = 0; j < n - 1; ++j) {
+			int col = j < node ? j : j + 1;
+			adjacency(i, j) = adjacency_(row, col);
+		}
+	}
+	adjacency_ = adjacency;
+	location_.erase(location_.begin() + node);
+}
+
+void AdjacencyGraph::Quantize() {
+	CHECK(!quantized());
+	int n = adjacency_.rows();
+	float longest = 0;
+	for (int i = 0; i < n; ++i) {
+		for (int j = 0; j < n; ++j) {
+			float weight = adjacency_(i, j);
+			CHECK(weight >= 0 && weight < INFINITY)
+					<< "Only finite non-negative weights are quantized.";
+			longest = std::max(longest, weight);
+		}
+	}
+	quantization_scale_ = longest > 0 ? longest / UINT16_MAX : 1;
+	quantized_.Allocate(n, n, 1, 0);
+	for (int i = 0; i < n; ++i) {
+		for (int j = 0; j < n; ++j) {
+			quantized_(i, j) = static_cast<uint16_t>(std::min<long>(UINT16_MAX,
+					std::lround(adjacency_(i, j) / quantization_scale_)));
+		}
+	}
+	adjacency_.Allocate(0, 0, 1, 0);
+}
+
 void AdjacencyGraph::SetLocation(int node, const Vector<float>& location) {
 	CHECK_LT(node, location_.size());
 	location_[node] = location;
 }
 
 std::string AdjacencyGraph::ToString() const {
+	ScopedTimer timer(StatsPhase::SERIALIZE);
 	std::string output;
 	// Adding the number of Nodes.
 	output.append(std::to_string(location_.size()));
@@ -102,6 +170,9 @@ void AdjacencyGraph::Initialize(int n, GraphType direction,
 	CHECK_GT(n, 0);
 	graph_type_ = direction;
 	adjacency_.Allocate(n, n, 1, default_value);
+	quantized_.Allocate(0, 0, 1, 0);
+	quantization_scale_ = 1;
+	location_.clear();
 	for (int i = 0; i < n; ++i) {
 		location_.push_back(Vector<float>(0, 0));
 	}
@@ -109,6 +180,7 @@ void AdjacencyGraph::Initialize(int n, GraphType direction,
 }
 
 std::string AdjacencyGraph::ToTikz() const {
+	ScopedTimer timer(StatsPhase::SERIALIZE);
 	std::string tex;
 	float scale = 1.8f;
 	std::string node_class = "vertex";
@@ -17,6 +17,8 @@
 #ifndef ADJACENCY_GRAPH_HPP_
 #define ADJACENCY_GRAPH_HPP_
 
+#include <cstdint>
+
 #include <matrix.hpp>
 #include <vector.hpp>
 #include <types.hpp>
@@ -50,12 +52,72 @@ public:
 
 	virtual void AddEuclideanWeightedEdge(int source, int target);
 
+	/**
+	 * Appends a node and connects it to every existing node with Euclidean
+	 * weighted edges.
+	 *
+	 * Time Complexity: O(V^2), the adjacency matrix is reallocated.
+	 *
+	 * @param location: The location of the new node.
+	 * @return the index of the new node, i.e. the previous number of nodes.
+	 */
+	virtual int AddEuclideanNode(const Vector<float>& location);
+
+	/**
+	 * Removes a node and its edges. The nodes with a higher index are shifted
+	 * down by one, keeping their relative order.
+	 *
+	 * Time Complexity: O(V^2), the adjacency matrix is reallocated.
+	 *
+	 * @param node: The index of the node to be removed.
+	 */
+	virtual void RemoveNode(int node);
+
+	/**
+	 * Replaces the weights by 16-bit units of a per-graph scale, i.e. each
+	 * weight w is stored as round(w / scale) with scale = max(w) / 65535,
+	 * which halves the memory of the matrix at a relative error of at most
+	 * 2^-17 of the longest edge. The float matrix is released, therefore the
+	 * edges cannot be changed and adjacency() is empty afterwards;
+	 * N1Graph::Minimize and N1Graph::Evaluate widen the units in their
+	 * kernels.
+	 *
+	 * Time Complexity: O(V^2)
+	 */
+	void Quantize();
+
+	bool quantized() const {
+		return quantized_.rows() > 0;
+	}
+
+	const Matrix<uint16_t>& quantized_adjacency() const {
+		return quantized_;
+	}
+
+	/**
+	 * The weight of one unit of the quantized matrix.
+	 */
+	float quantization_scale() const {
+		return quantization_scale_;
+	}
+
+	/**
+	 * Sets the pages and the NUMA placement of the distance matrices, which
+	 * are moved if already allocated.
+	 *
+	 * Time Complexity: O(V^2)
+	 */
+	void set_allocation_policy(const AllocationPolicy& policy) {
+		adjacency_.set_allocation_policy(policy);
+		quantized_.set_allocation_policy(policy);
+	}
+
 	virtual std::string ToString() const;
 
 	virtual std::string ToTikz() const;
 
 	virtual size_t NumberOfNodes() const {
-		return adjacency_.rows();
+		return quantized() ? quantized_.rows() : adjacency_.rows();
 	}
 
 	virtual ~AdjacencyGraph();
@@ -69,7 +131,7 @@ public:
 	}
 
 	const Vector<float>& location(int node) const {
-		CHECK_LT(node, location_.size());
+		DCHECK_LT(node, location_.size());
 		return location_[node];
 	}
 
@@ -104,6 +166,9 @@ private:
 	GraphType graph_type_;
 	std::vector<Vector<float>> location_;
 	Matrix<float> adjacency_;
+	// The weights in units of quantization_scale_, once quantized.
+	Matrix<uint16_t> quantized_;
+	float quantization_scale_;
 };
 
 } /* namespace n1graph */
@@ -0,0 +1,170 @@
+/*
+ * Copyright 2014 Samuel de Sousa
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <batch_matching.hpp>
+
+#include <cstdint>
+#include <fstream>
+
+#include <glog/logging.h>
+
+#include <stats.hpp>
+#include <tracer.hpp>
+
+namespace n1graph {
+
+namespace {
+
+// Encodes value in width little-endian bytes.
+char* EncodeUInt(uint32_t value, int width, char* bytes) {
+	for (int b = 0; b < width; ++b) {
+		*bytes++ = static_cast<char>((value >> (8 * b)) & 0xFF);
+	}
+	return bytes;
+}
+
+}  // namespace
+
+BatchMatching::BatchMatching() :
+		number_of_points_(0) {
+}
+
+BatchMatching::~BatchMatching() {
+}
+
+void BatchMatching::Solve(const std::vector<AdjacencyGraph>& scans,
+		Executor* executor) {
+	if (executor == nullptr)
+		executor = Executor::Default();
+	LOG(INFO) << "Solving " << scans.size() << " scans";
+	CHECK_GT(scans.size(), 0);
+	number_of_points_ = scans[0].NumberOfNodes();
+	for (const AdjacencyGraph& scan : scans) {
+		CHECK_EQ(scan.NumberOfNodes(), number_of_points_);
+	}
+	graphs_.clear();
+	graphs_.resize(scans.size());
+	ranks_.assign(scans.size(), std::vector<int>(number_of_points_));
+	tensor_.clear();
+	executor->ParallelFor(0, scans.size(), [&](int s) {
+		graphs_[s].set_executor(executor);
+		graphs_[s].Minimize(scans[s]);
+		const std::vector<int>& nodes = graphs_[s].nodes();
+		for (int i = 0; i < number_of_points_; ++i) {
+			ranks_[s][nodes[i]] = i;
+		}
+	});
+}
+
+void BatchMatching::RegisterAll(Executor* executor) {
+	if (executor == nullptr)
+		executor = Executor::Default();
+	ScopedTimer timer(StatsPhase::REGISTER);
+	ScopedTrace trace(StatsPhase::REGISTER);
+	LOG(INFO) << "Registering " << graphs_.size() << " scans";
+	int k = graphs_.size();
+	int n = number_of_points_;
+	tensor_.resize(static_cast<size_t>(k) * k * n);
+	executor->ParallelFor(0, k * k, [&](int pair) {
+		int source = pair / k;
+		int target = pair % k;
+		const std::vector<int>& rank = ranks_[source];
+		const std::vector<int>& nodes = graphs_[target].nodes();
+		int* row = &tensor_[static_cast<size_t>(pair) * n];
+		for (int i = 0; i < n; ++i) {
+			row[i] = nodes[rank[i]];
+		}
+	});
+}
+
+int BatchMatching::Correspondence(int source, int target, int point) const {
+	CHECK_GE(source, 0);
+	CHECK_GE(target, 0);
+	CHECK_GE(point, 0);
+	CHECK_LT(source, graphs_.size());
+	CHECK_LT(target, graphs_.size());
+	CHECK_LT(point, number_of_points_);
+	CHECK_EQ(tensor_.size(), graphs_.size() * graphs_.size()
+			* number_of_points_);
+	size_t k = graphs_.size();
+	return tensor_[(source * k + target) * number_of_points_ + point];
+}
+
+std::vector<int> BatchMatching::Correspondence(int source, int target) const {
+	std::vector<int> mapping(number_of_points_);
+	for (int i = 0; i < number_of_points_; ++i) {
+		mapping[i] = Correspondence(source, target, i);
+	}
+	return mapping;
+}
+
+std::vector<int> BatchMatching::Compose(const std::vector<int>& path) const {
+	CHECK_GE(path.size(), 2);
+	std::vector<int> mapping = Correspondence(path[0], path[1]);
+	for (int p = 2; p < static_cast<int>(path.size()); ++p) {
+		mapping = Compose(mapping, Correspondence(path[p - 1], path[p]));
+	}
+	return mapping;
+}
+
+std::vector<int> BatchMatching::Compose(const std::vector<int>& first,
+		const std::vector<int>& second) {
+	std::vector<int> mapping(first.size());
+	for (int i = 0; i < static_cast<int>(first.size()); ++i) {
+		CHECK_GE(first[i], 0);
+		CHECK_LT(first[i], second.size());
+		mapping[i] = second[first[i]];
+	}
+	return mapping;
+}
+
+void BatchMatching::WriteBinary(const std::string& location) const {
+	ScopedTimer timer(StatsPhase::SERIALIZE);
+	ScopedTrace trace(StatsPhase::SERIALIZE);
+	size_t k = graphs_.size();
+	CHECK_EQ(tensor_.size(), k * k * number_of_points_);
+	int width = number_of_points_ <= 0xFFFF ? 2 : 4;
+	std::ofstream output(location.c_str(), std::ios::binary);
+	CHECK(output.is_open()) << "Could not open " << location;
+	char header[20] = {'N', '1', 'C', 'T'};
+	char* field = EncodeUInt(1, 4, header + 4);
+	field = EncodeUInt(k, 4, field);
+	field = EncodeUInt(number_of_points_, 4, field);
+	EncodeUInt(width, 4, field);
+	output.write(header, sizeof(header));
+	// Each row of V elements is written at once.
+	std::vector<char> row(static_cast<size_t>(number_of_points_) * width);
+	for (size_t offset = 0; offset < tensor_.size();
+			offset += number_of_points_) {
+		char* bytes = row.data();
+		for (int i = 0; i < number_of_points_; ++i) {
+			bytes = EncodeUInt(tensor_[offset + i], width, bytes);
+		}
+		output.write(row.data(), row.size());
+	}
+	output.close();
+	CHECK(output) << "Could not write " << location;
+	Stats::Increment(StatsCounter::BYTES_WRITTEN, 20 + tensor_.size() * width);
+}
+
+const N1Graph& BatchMatching::graph(int scan) const {
+	CHECK_GE(scan, 0);
+	CHECK_LT(scan, graphs_.size());
+	return graphs_[scan];
+}
+
+} /* namespace n1graph */
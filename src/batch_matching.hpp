@@ -0,0 +1,136 @@
+/*
+ * Copyright 2014 Samuel de Sousa
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef BATCH_MATCHING_HPP_
+#define BATCH_MATCHING_HPP_
+
+#include <string>
+#include <vector>
+
+#include <adjacency_graph.hpp>
+#include <executor.hpp>
+#include <n1graph.hpp>
+
+namespace n1graph {
+
+/**
+ * Registers every pair within a set of K scans, e.g. all the frames of a
+ * capture session. Each scan is minimized only once, all the K^2 pairs are
+ * then read from the join/isolate sequences, which costs O(V) per pair.
+ */
+class BatchMatching {
+public:
+	BatchMatching();
+
+	/**
+	 * Minimizes all the scans in parallel. The scans need to have the same
+	 * number of points.
+	 *
+	 * Time Complexity: K times the one of N1Graph::Minimize.
+	 *
+	 * @param scans: The complete graphs of the point-sets.
+	 * @param executor: The executor of the parallel loop, nullptr for
+	 * Executor::Default().
+	 */
+	void Solve(const std::vector<AdjacencyGraph>& scans, Executor* executor =
+			nullptr);
+
+	/**
+	 * Fills the K x K x V correspondence tensor in parallel.
+	 *
+	 * Time Complexity: O(K^2 * V)
+	 * Space Complexity: O(K^2 * V)
+	 *
+	 * @param executor: The executor of the parallel loop, nullptr for
+	 * Executor::Default().
+	 */
+	void RegisterAll(Executor* executor = nullptr);
+
+	/**
+	 * Returns the point of the target scan which corresponds to a point of
+	 * the source scan.
+	 *
+	 * Time Complexity: O(1)
+	 */
+	int Correspondence(int source, int target, int point) const;
+
+	/**
+	 * Returns the correspondence of all the points of the source scan into
+	 * the target scan.
+	 *
+	 * Time Complexity: O(V)
+	 */
+	std::vector<int> Correspondence(int source, int target) const;
+
+	/**
+	 * Chains the correspondences along a path of scans, e.g. {A, B, C}
+	 * yields the mapping A->B->C without registering A and C.
+	 *
+	 * Time Complexity: O(P * V) for a path with P scans.
+	 *
+	 * @param path: The indices of the scans, at least two.
+	 * @return for each point of path[0], the point of the last scan.
+	 */
+	std::vector<int> Compose(const std::vector<int>& path) const;
+
+	/**
+	 * Composes two mappings, returning second[first[i]] for each i.
+	 *
+	 * Time Complexity: O(V)
+	 */
+	static std::vector<int> Compose(const std::vector<int>& first,
+			const std::vector<int>& second);
+
+	/**
+	 * Writes the correspondence tensor in binary format: the magic "N1CT",
+	 * followed by the uint32 fields version, K, V and the element width in
+	 * bytes, followed by the K x K x V elements in row-major order. Each
+	 * element takes 2 bytes when V fits into 16 bits, otherwise 4 bytes. All
+	 * values are little-endian.
+	 *
+	 * Time Complexity: O(K^2 * V)
+	 *
+	 * @param location: The output file location.
+	 */
+	void WriteBinary(const std::string& location) const;
+
+	/**
+	 * Returns the solved G_N graph of a scan.
+	 */
+	const N1Graph& graph(int scan) const;
+
+	int number_of_scans() const {
+		return graphs_.size();
+	}
+
+	int number_of_points() const {
+		return number_of_points_;
+	}
+
+	virtual ~BatchMatching();
+
+private:
+	int number_of_points_;
+	std::vector<N1Graph> graphs_;
+	// Position of each node in the join/isolate sequence of each scan.
+	std::vector<std::vector<int> > ranks_;
+	// The K x K x V correspondence tensor, flattened.
+	std::vector<int> tensor_;
+};
+
+} /* namespace n1graph */
+#endif /* BATCH_MATCHING_HPP_ */
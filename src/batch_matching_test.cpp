@@ -0,0 +1,97 @@
+/*
+ * Copyright 2014 Samuel de Sousa
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "gtest/gtest.h"
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <batch_matching.hpp>
+#include <generator.hpp>
+
+using namespace n1graph;
+
+namespace {
+
+// Reads a little-endian unsigned integer of the given width.
+uint32_t ReadUInt(std::ifstream& input, int width) {
+	uint32_t value = 0;
+	for (int b = 0; b < width; ++b) {
+		value |= static_cast<uint32_t>(input.get()) << (8 * b);
+	}
+	return value;
+}
+
+BatchMatching Scans(int k, int n) {
+	std::vector<AdjacencyGraph> scans;
+	for (int i = 0; i < k; ++i) {
+		scans.push_back(Generator::EuclideanGraph(
+				Generator::Uniform(n, 100.f, 200 + i)));
+	}
+	BatchMatching batch;
+	batch.Solve(scans);
+	batch.RegisterAll();
+	return batch;
+}
+
+}  // namespace
+
+TEST(BatchMatchingTest, WriteBinaryRoundTrip) {
+	BatchMatching batch = Scans(3, 10);
+	std::string location = ::testing::TempDir() + "n1graph_tensor.bin";
+	batch.WriteBinary(location);
+	std::ifstream input(location.c_str(), std::ios::binary);
+	ASSERT_TRUE(input.is_open());
+	char magic[4];
+	input.read(magic, 4);
+	EXPECT_EQ(std::string(magic, 4), "N1CT");
+	EXPECT_EQ(ReadUInt(input, 4), 1);
+	EXPECT_EQ(ReadUInt(input, 4), 3);
+	EXPECT_EQ(ReadUInt(input, 4), 10);
+	EXPECT_EQ(ReadUInt(input, 4), 2);
+	for (int source = 0; source < 3; ++source) {
+		for (int target = 0; target < 3; ++target) {
+			for (int point = 0; point < 10; ++point) {
+				EXPECT_EQ(ReadUInt(input, 2),
+						batch.Correspondence(source, target, point));
+			}
+		}
+	}
+	input.get();
+	EXPECT_TRUE(input.eof());
+}
+
+TEST(BatchMatchingTest, ComposeChainsCorrespondences) {
+	BatchMatching batch = Scans(3, 10);
+	std::vector<int> identity = batch.Correspondence(1, 1);
+	for (int point = 0; point < 10; ++point)
+		EXPECT_EQ(identity[point], point);
+	EXPECT_EQ(batch.Compose({ 0, 1, 2 }),
+			BatchMatching::Compose(batch.Correspondence(0, 1),
+					batch.Correspondence(1, 2)));
+	EXPECT_EQ(batch.Compose({ 0, 2 }), batch.Correspondence(0, 2));
+}
+
+TEST(BatchMatchingTest, WriteBinaryFailsOnShortWrite) {
+	std::ofstream full("/dev/full");
+	if (!full.is_open())
+		GTEST_SKIP() << "No /dev/full to fill.";
+	BatchMatching batch = Scans(2, 8);
+	EXPECT_DEATH(batch.WriteBinary("/dev/full"), "Could not write");
+}
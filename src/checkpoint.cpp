@@ -0,0 +1,170 @@
+/*
+ * Copyright 2014 Samuel de Sousa
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <checkpoint.hpp>
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include <glog/logging.h>
+
+#include <stats.hpp>
+
+namespace n1graph {
+
+namespace {
+
+const uint32_t kVersion = 2;
+
+void WriteUInt(std::ofstream& output, uint64_t value, int width) {
+	for (int b = 0; b < width; ++b) {
+		output.put(static_cast<char>((value >> (8 * b)) & 0xFF));
+	}
+}
+
+bool ReadUInt(std::ifstream& input, int width, uint64_t* value) {
+	*value = 0;
+	for (int b = 0; b < width; ++b) {
+		int byte = input.get();
+		if (byte == std::char_traits<char>::eof())
+			return false;
+		*value |= static_cast<uint64_t>(byte) << (8 * b);
+	}
+	return true;
+}
+
+uint32_t FloatBits(float value) {
+	uint32_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	return bits;
+}
+
+float BitsFloat(uint64_t bits) {
+	uint32_t value = static_cast<uint32_t>(bits);
+	float result;
+	memcpy(&result, &value, sizeof(result));
+	return result;
+}
+
+// A list of nodes: its length followed by the nodes.
+void WriteNodes(std::ofstream& output, const std::vector<int>& nodes) {
+	WriteUInt(output, nodes.size(), 4);
+	for (int node : nodes) {
+		WriteUInt(output, node, 4);
+	}
+}
+
+bool ReadNodes(std::ifstream& input, size_t n, std::vector<int>* nodes) {
+	uint64_t size, node;
+	if (!ReadUInt(input, 4, &size) || size > n)
+		return false;
+	nodes->resize(size);
+	for (uint64_t k = 0; k < size; ++k) {
+		if (!ReadUInt(input, 4, &node) || node >= n)
+			return false;
+		(*nodes)[k] = node;
+	}
+	return true;
+}
+
+}  // namespace
+
+uint64_t Checkpoint::Fingerprint(const AdjacencyGraph& input,
+		const std::vector<int64_t>& settings) {
+	// FNV-1a over the number of nodes, the bits of the weights and the
+	// settings.
+	uint64_t hash = 14695981039346656037ULL;
+	int n = input.NumberOfNodes();
+	hash = (hash ^ static_cast<uint64_t>(n)) * 1099511628211ULL;
+	for (int i = 0; i < n; ++i) {
+		for (int j = 0; j < n; ++j) {
+			uint64_t bits = input.quantized() ?
+					input.quantized_adjacency()(i, j) :
+					FloatBits(input.adjacency()(i, j));
+			hash = (hash ^ bits) * 1099511628211ULL;
+		}
+	}
+	for (int64_t setting : settings) {
+		hash = (hash ^ static_cast<uint64_t>(setting)) * 1099511628211ULL;
+	}
+	return hash;
+}
+
+void Checkpoint::Write(const std::string& location) const {
+	size_t n = completed_.size();
+	bool incremental = !sweeps_.empty();
+	std::string temporary = location + ".tmp";
+	std::ofstream output(temporary.c_str(), std::ios::binary);
+	CHECK(output.is_open()) << "Could not open " << temporary;
+	output.write("N1CK", 4);
+	WriteUInt(output, kVersion, 4);
+	WriteUInt(output, fingerprint_, 8);
+	WriteUInt(output, n, 4);
+	for (char completed : completed_) {
+		output.put(completed);
+	}
+	WriteUInt(output, FloatBits(best_cost_), 4);
+	WriteUInt(output, FloatBits(second_cost_), 4);
+	WriteNodes(output, best_nodes_);
+	WriteUInt(output, incremental, 1);
+	for (size_t i = 0; incremental && i < n; ++i) {
+		WriteUInt(output, FloatBits(sweep_costs_[i]), 4);
+		WriteNodes(output, sweeps_[i]);
+	}
+	int64_t bytes = output.tellp();
+	output.close();
+	CHECK(!output.fail()) << "Could not write " << temporary;
+	CHECK_EQ(std::rename(temporary.c_str(), location.c_str()), 0)
+			<< "Could not replace " << location;
+	Stats::Increment(StatsCounter::BYTES_WRITTEN, bytes);
+}
+
+bool Checkpoint::Read(const std::string& location, uint64_t fingerprint,
+		size_t n) {
+	std::ifstream input(location.c_str(), std::ios::binary);
+	if (!input.is_open())
+		return false;
+	char magic[4];
+	uint64_t version, nodes, value;
+	if (!input.read(magic, 4) || memcmp(magic, "N1CK", 4) != 0
+			|| !ReadUInt(input, 4, &version) || version != kVersion
+			|| !ReadUInt(input, 8, &fingerprint_) || fingerprint_ != fingerprint
+			|| !ReadUInt(input, 4, &nodes) || nodes != n)
+		return false;
+	completed_.resize(n);
+	if (!input.read(completed_.data(), n) || !ReadUInt(input, 4, &value))
+		return false;
+	best_cost_ = BitsFloat(value);
+	if (!ReadUInt(input, 4, &value))
+		return false;
+	second_cost_ = BitsFloat(value);
+	if (!ReadNodes(input, n, &best_nodes_) || !ReadUInt(input, 1, &value))
+		return false;
+	bool incremental = value != 0;
+	sweeps_.assign(incremental ? n : 0, std::vector<int>());
+	sweep_costs_.assign(sweeps_.size(), 0);
+	for (size_t i = 0; i < sweeps_.size(); ++i) {
+		if (!ReadUInt(input, 4, &value) || !ReadNodes(input, n, &sweeps_[i]))
+			return false;
+		sweep_costs_[i] = BitsFloat(value);
+	}
+	Stats::Increment(StatsCounter::BYTES_READ, input.tellg());
+	return true;
+}
+
+} /* namespace n1graph */
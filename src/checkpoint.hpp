@@ -0,0 +1,87 @@
+/*
+ * Copyright 2014 Samuel de Sousa
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef CHECKPOINT_HPP_
+#define CHECKPOINT_HPP_
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <adjacency_graph.hpp>
+
+namespace n1graph {
+
+/**
+ * The state of a run of Minimize from which it can be resumed: the initial
+ * nodes already swept and the best sweep among them. The solver has no
+ * random state and sweeps the initial nodes in increasing order, thus this
+ * is enough for a resumed run to find the same solution.
+ */
+struct Checkpoint {
+	Checkpoint() :
+			fingerprint_(0), best_cost_(0), second_cost_(
+					std::numeric_limits<float>::max()) {
+	}
+
+	/**
+	 * A hash of the number of nodes and of the weights of input, and of the
+	 * solver settings which change the sweeps, which ties a checkpoint to its
+	 * input and its configuration.
+	 *
+	 * Time Complexity: O(V^2).
+	 *
+	 * @param settings: E.g. the sampling of the initial nodes, the number of
+	 * candidates and the precision.
+	 */
+	static uint64_t Fingerprint(const AdjacencyGraph& input,
+			const std::vector<int64_t>& settings);
+
+	/**
+	 * Writes the checkpoint into a temporary file which then replaces the one
+	 * at location, so that a crash never leaves a truncated checkpoint.
+	 */
+	void Write(const std::string& location) const;
+
+	/**
+	 * Reads a checkpoint written by Write for an input with the given
+	 * fingerprint and number of nodes. A file of another input is rejected
+	 * before anything of its size is allocated.
+	 *
+	 * @return false if there is no valid checkpoint of the input at location.
+	 */
+	bool Read(const std::string& location, uint64_t fingerprint, size_t n);
+
+	uint64_t fingerprint_;
+	// Whether the sweep of each initial node is done.
+	std::vector<char> completed_;
+	// The best complete sweep, with the lowest initial node among the ties.
+	// Empty if none.
+	float best_cost_;
+	std::vector<int> best_nodes_;
+	// The second lowest cost of the complete sweeps, which the gap of a
+	// sampled run needs, the maximum float if there is none.
+	float second_cost_;
+	// The sweep of each completed initial node and its cost, kept only by an
+	// incremental run.
+	std::vector<std::vector<int> > sweeps_;
+	std::vector<float> sweep_costs_;
+};
+
+} /* namespace n1graph */
+#endif /* CHECKPOINT_HPP_ */
@@ -0,0 +1,110 @@
+/*
+ * Copyright 2014 Samuel de Sousa
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "gtest/gtest.h"
+
+#include <fstream>
+#include <string>
+
+#include <checkpoint.hpp>
+#include <generator.hpp>
+#include <n1graph.hpp>
+
+using namespace n1graph;
+
+namespace {
+
+Checkpoint Sample() {
+	Checkpoint checkpoint;
+	checkpoint.fingerprint_ = 42;
+	checkpoint.completed_ = { 1, 1, 0, 0, 0 };
+	checkpoint.best_cost_ = 3.5f;
+	checkpoint.best_nodes_ = { 1, 0, 2, 4, 3 };
+	return checkpoint;
+}
+
+}  // namespace
+
+TEST(CheckpointTest, ReadsItsOwnInput) {
+	std::string location = ::testing::TempDir() + "n1graph_checkpoint_test";
+	Sample().Write(location);
+	Checkpoint checkpoint;
+	ASSERT_TRUE(checkpoint.Read(location, 42, 5));
+	EXPECT_EQ(checkpoint.completed_, Sample().completed_);
+	EXPECT_EQ(checkpoint.best_cost_, 3.5f);
+	EXPECT_EQ(checkpoint.best_nodes_, Sample().best_nodes_);
+	EXPECT_TRUE(checkpoint.sweeps_.empty());
+}
+
+TEST(CheckpointTest, RejectsAnotherInput) {
+	std::string location = ::testing::TempDir() + "n1graph_checkpoint_test";
+	Sample().Write(location);
+	Checkpoint checkpoint;
+	EXPECT_FALSE(checkpoint.Read(location, 43, 5));
+	EXPECT_FALSE(checkpoint.Read(location, 42, 6));
+	// A corrupt number of nodes is rejected before it is allocated.
+	std::fstream file(location.c_str(),
+			std::ios::binary | std::ios::in | std::ios::out);
+	file.seekp(16);
+	file.write("\xff\xff\xff\xff", 4);
+	file.close();
+	EXPECT_FALSE(checkpoint.Read(location, 42, 5));
+	EXPECT_TRUE(checkpoint.completed_.empty());
+}
+
+TEST(CheckpointTest, ResumesASampledRun) {
+	AdjacencyGraph input = Generator::EuclideanGraph(
+			Generator::Uniform(30, 100.f, 46));
+	std::string location = ::testing::TempDir() + "n1graph_sampled_checkpoint";
+	N1Graph full;
+	full.set_start_sampling(StartSampling::SPREAD_STARTS, 10, 7);
+	full.Minimize(input);
+	ASSERT_GT(full.sampling_estimate().gap_, 0);
+	// Runs with the given sample count from the checkpoint, if it matches,
+	// and returns the number of initial nodes done at the first progress.
+	auto run = [&](int count, bool interrupt, N1Graph* graph) {
+		CancellationToken token;
+		int first_completed = 0;
+		graph->set_start_sampling(StartSampling::SPREAD_STARTS, count, 7);
+		graph->set_checkpoint(location, 1);
+		graph->set_cancellation(token);
+		graph->set_progress([&](const MinimizeProgress& progress) {
+			if (first_completed == 0)
+				first_completed = progress.completed_;
+			if (interrupt && progress.completed_ >= 5)
+				token.Cancel();
+		}, 1);
+		graph->Minimize(input);
+		EXPECT_EQ(graph->cancelled(), interrupt);
+		return first_completed;
+	};
+
+	// Another configuration starts over.
+	N1Graph interrupted;
+	EXPECT_EQ(run(10, true, &interrupted), 1);
+	N1Graph other;
+	EXPECT_EQ(run(12, false, &other), 1);
+
+	// The same configuration resumes, with the gap of all the sweeps.
+	EXPECT_EQ(run(10, true, &interrupted), 1);
+	N1Graph resumed;
+	EXPECT_EQ(run(10, false, &resumed), 6);
+	EXPECT_EQ(resumed.nodes(), full.nodes());
+	EXPECT_EQ(resumed.sampling_estimate().best_cost_,
+			full.sampling_estimate().best_cost_);
+	EXPECT_EQ(resumed.sampling_estimate().gap_, full.sampling_estimate().gap_);
+}
@@ -20,6 +20,9 @@
 #include <fstream>
 #include <sstream>
 #include <vector>
+
+#include <stats.hpp>
+#include <tracer.hpp>
 #include <vector.hpp>
 
 namespace n1graph {
@@ -44,15 +47,19 @@ public:
 
 	static std::vector<Vector<float> > ReadCSV(const std::string &filename,
 			char delim) {
-
+		ScopedTimer timer(StatsPhase::READ_CSV);
+		ScopedTrace trace(StatsPhase::READ_CSV);
 		std::vector<Vector<float> > values;
 		std::ifstream in(filename.c_str());
 		if (!in.is_open())
 			return values;
 		std::string line;
+		int64_t bytes = 0;
 		while (std::getline(in, line)) {
 			values.push_back(split(line, delim));
+			bytes += line.size() + 1;
 		}
+		Stats::Increment(StatsCounter::BYTES_READ, bytes);
 
 		return values;
 	}
@@ -46,7 +46,7 @@ Vector<int> Degree<T>::DegreeLength(const Matrix<T>& adjacency,
 	CHECK_EQ(adjacency.rows(), mask.size());
 	std::vector<int> degree_vector = Degree<T>::DegreeVector(adjacency);
 	std::set<int> unique_elements;
-	for (int i = 0; i < mask.size(); ++i) {
+	for (int i = 0; i < static_cast<int>(mask.size()); ++i) {
 		if ( mask[i] )
 			unique_elements.insert(degree_vector[i]);
 	}
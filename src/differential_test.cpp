@@ -0,0 +1,487 @@
+/*
+ * Copyright 2014 Samuel de Sousa
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <future>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <adjacency_graph.hpp>
+#include <executor.hpp>
+#include <generator.hpp>
+#include <n1graph.hpp>
+
+using namespace n1graph;
+
+/**
+ * Differential tests: every variant of Minimize has to yield the same nodes
+ * and the same cost as the CUBE strategy, the reference implementation, on
+ * randomly generated point-sets. A failing point-set is minimized before it
+ * is reported.
+ */
+namespace {
+
+struct Solution {
+	std::vector<int> nodes;
+	float cost;
+};
+
+// A variant receives the point-set and the reference solution.
+typedef std::function<
+		Solution(const std::vector<Vector<float> >&, const Solution&)> Variant;
+
+struct NamedVariant {
+	std::string name;
+	Variant solve;
+};
+
+Solution Reference(const std::vector<Vector<float> >& points) {
+	N1Graph graph;
+	graph.set_strategy(SolverStrategy::CUBE);
+	graph.set_small_solver(false);
+	graph.Minimize(Generator::EuclideanGraph(points));
+	return {graph.nodes(), graph.cost()};
+}
+
+Solution WithStrategy(const std::vector<Vector<float> >& points,
+		SolverStrategy strategy, const Solution&) {
+	N1Graph graph;
+	graph.set_strategy(strategy);
+	graph.set_small_solver(false);
+	graph.Minimize(Generator::EuclideanGraph(points));
+	return {graph.nodes(), graph.cost()};
+}
+
+// The automatic selection under a budget which only fits the rolling sweeps.
+Solution Auto(const std::vector<Vector<float> >& points, const Solution&) {
+	N1Graph graph;
+	SolverBudget budget;
+	budget.memory_bytes_ = N1Graph::EstimateMemory(points.size(),
+			SolverStrategy::ROLLING, false);
+	graph.set_budget(budget);
+	graph.set_strategy(SolverStrategy::AUTO);
+	graph.set_small_solver(false);
+	graph.Minimize(Generator::EuclideanGraph(points));
+	EXPECT_TRUE(graph.plan().fits_);
+	return {graph.nodes(), graph.cost()};
+}
+
+// An asynchronous run observed by a progress callback.
+Solution Async(const std::vector<Vector<float> >& points, const Solution&) {
+	AdjacencyGraph input = Generator::EuclideanGraph(points);
+	InlineExecutor executor;
+	N1Graph graph;
+	MinimizeProgress last = { 0, 0, 0 };
+	graph.set_progress([&last](const MinimizeProgress& progress) {
+		last = progress;
+	}, 3);
+	std::future<bool> done = graph.MinimizeAsync(input, &executor);
+	EXPECT_TRUE(done.get());
+	EXPECT_EQ(last.completed_, points.size());
+	EXPECT_EQ(last.best_cost_, graph.cost());
+	return {graph.nodes(), graph.cost()};
+}
+
+// A run cancelled half way, then resumed from its checkpoint.
+Solution Resume(const std::vector<Vector<float> >& points, const Solution&) {
+	AdjacencyGraph input = Generator::EuclideanGraph(points);
+	std::string location = ::testing::TempDir() + "n1graph_checkpoint";
+	CancellationToken token;
+	N1Graph interrupted;
+	interrupted.set_checkpoint(location, 2);
+	interrupted.set_cancellation(token);
+	interrupted.set_progress([&token, &points](const MinimizeProgress& progress) {
+		if (2 * progress.completed_ >= static_cast<int>(points.size()))
+			token.Cancel();
+	}, 1);
+	interrupted.Minimize(input);
+	EXPECT_EQ(interrupted.cancelled(), points.size() > 1);
+	N1Graph resumed;
+	resumed.set_checkpoint(location, 2);
+	resumed.Minimize(input);
+	EXPECT_FALSE(resumed.cancelled());
+	return {resumed.nodes(), resumed.cost()};
+}
+
+// The stack-only solver of the small point-sets.
+Solution Small(const std::vector<Vector<float> >& points, const Solution&) {
+	N1Graph graph;
+	graph.Minimize(Generator::EuclideanGraph(points));
+	return {graph.nodes(), graph.cost()};
+}
+
+// A sample as large as the graph is the full search, with no gap.
+Solution Sampled(const std::vector<Vector<float> >& points, const Solution&) {
+	N1Graph graph;
+	graph.set_start_sampling(StartSampling::SPREAD_STARTS, points.size(), 7);
+	graph.Minimize(Generator::EuclideanGraph(points));
+	EXPECT_EQ(graph.sampling_estimate().sampled_, points.size());
+	EXPECT_EQ(graph.sampling_estimate().gap_, 0);
+	return {graph.nodes(), graph.cost()};
+}
+
+// The evaluation of the reference sequence, alone and in a batch.
+Solution Evaluated(const std::vector<Vector<float> >& points,
+		const Solution& reference) {
+	AdjacencyGraph input = Generator::EuclideanGraph(points);
+	std::vector<std::vector<int> > orders(3, reference.nodes);
+	std::vector<float> costs = N1Graph::Evaluate(input, orders);
+	EXPECT_EQ(costs[2], reference.cost);
+	return {reference.nodes, N1Graph::Evaluate(input, reference.nodes)};
+}
+
+// A warm start from the reference solution has to keep it.
+Solution WarmStart(const std::vector<Vector<float> >& points,
+		const Solution& reference) {
+	N1Graph graph;
+	graph.Minimize(Generator::EuclideanGraph(points), reference.nodes,
+			reference.cost, 0);
+	return {graph.nodes(), graph.cost()};
+}
+
+// The sweeps of Minimize accumulated in double precision: from each initial
+// node, the first missing node with the strictly lowest cost is appended, and
+// the first initial node with the strictly lowest cost is kept.
+std::vector<int> PreciseReference(const AdjacencyGraph& input, double* cost) {
+	const Matrix<float>& distances = input.adjacency();
+	int n = input.NumberOfNodes();
+	std::vector<int> best_nodes;
+	for (int start = 0; start < n; ++start) {
+		std::vector<int> nodes(1, start);
+		std::vector<bool> used(n, false);
+		used[start] = true;
+		double sweep_cost = 0;
+		for (int k = 1; k < n; ++k) {
+			int candidate = -1;
+			double candidate_cost = 0;
+			for (int j = 0; j < n; ++j) {
+				if (used[j])
+					continue;
+				double new_cost = 0;
+				if (k % 2 == 0) {
+					for (int i = 0; i < n; ++i) {
+						if (used[i])
+							new_cost += distances(j, i);
+					}
+				} else {
+					new_cost = distances(j, nodes.back());
+				}
+				new_cost += sweep_cost;
+				if (candidate < 0 || new_cost < candidate_cost) {
+					candidate = j;
+					candidate_cost = new_cost;
+				}
+			}
+			sweep_cost = candidate_cost;
+			nodes.push_back(candidate);
+			used[candidate] = true;
+		}
+		if (best_nodes.empty() || sweep_cost < *cost) {
+			best_nodes = nodes;
+			*cost = sweep_cost;
+		}
+	}
+	return best_nodes;
+}
+
+// The sweeps in a wider arithmetic have to find the sequence of the double
+// precision reference, and report its cost up to the rounding of that
+// arithmetic instead of the float one.
+Solution WithPrecision(const std::vector<Vector<float> >& points,
+		CostPrecision precision, double tolerance, const Solution& reference) {
+	AdjacencyGraph input = Generator::EuclideanGraph(points);
+	N1Graph graph;
+	graph.set_precision(precision);
+	graph.Minimize(input);
+	double expected = 0;
+	std::vector<int> expected_nodes = PreciseReference(input, &expected);
+	EXPECT_NEAR(graph.precise_cost(), expected, tolerance * (1 + expected));
+	if (graph.nodes() == expected_nodes)
+		return reference;
+	return {graph.nodes(), static_cast<float>(graph.precise_cost())};
+}
+
+// The sweeps over 16-bit distances. Each weight is off by at most half a
+// unit, therefore the cost of their sequence is within half a unit per summed
+// weight of its float cost. Rounding can break the ties of the float sums
+// the other way, after which the sequence follows another sweep, thus only
+// the cost of its own sequence is bounded.
+Solution Quantized(const std::vector<Vector<float> >& points,
+		const Solution& reference) {
+	AdjacencyGraph input = Generator::EuclideanGraph(points);
+	AdjacencyGraph quantized = input;
+	quantized.Quantize();
+	N1Graph graph;
+	graph.Minimize(quantized);
+	EXPECT_EQ(graph.cost(), N1Graph::Evaluate(quantized, graph.nodes()));
+	std::vector<int> sorted = graph.nodes();
+	std::sort(sorted.begin(), sorted.end());
+	for (int i = 0; i < static_cast<int>(sorted.size()); ++i)
+		EXPECT_EQ(sorted[i], i);
+	int n = points.size();
+	// The isolated nodes add one weight and the k-th node joins k of them.
+	double weights = 0;
+	for (int k = 1; k < n; ++k)
+		weights += k % 2 == 0 ? k : 1;
+	double expected = N1Graph::EvaluatePrecise(input, graph.nodes());
+	double bound = weights * quantized.quantization_scale() / 2
+			+ 1e-6 * expected;
+	if (std::abs(graph.cost() - expected) <= bound)
+		return reference;
+	return {graph.nodes(), graph.cost()};
+}
+
+// The local search from the reference solution only applies moves which
+// lower the cost.
+Solution Refined(const std::vector<Vector<float> >& points,
+		const Solution& reference) {
+	AdjacencyGraph input = Generator::EuclideanGraph(points);
+	N1Graph graph;
+	graph.Minimize(input);
+	graph.Refine(input, 0, 0);
+	EXPECT_EQ(graph.cost(), N1Graph::Evaluate(input, graph.nodes()));
+	if (N1Graph::EvaluatePrecise(input, graph.nodes())
+			<= N1Graph::EvaluatePrecise(input, reference.nodes))
+		return reference;
+	return {graph.nodes(), graph.cost()};
+}
+
+// The hierarchical approximation yields a sequence of all the nodes with its
+// exact cost and its gap to the full search, and with a single leaf it is the
+// full search.
+Solution Hierarchical(const std::vector<Vector<float> >& points,
+		const Solution& reference) {
+	AdjacencyGraph input = Generator::EuclideanGraph(points);
+	N1Graph approximate;
+	approximate.MinimizeHierarchical(input, 4, points.size());
+	EXPECT_EQ(approximate.sampling_estimate().gap_,
+			approximate.cost() - reference.cost);
+	std::vector<int> sorted = approximate.nodes();
+	std::sort(sorted.begin(), sorted.end());
+	for (int i = 0; i < static_cast<int>(sorted.size()); ++i)
+		EXPECT_EQ(sorted[i], i);
+	EXPECT_EQ(approximate.cost(),
+			N1Graph::Evaluate(input, approximate.nodes()));
+	N1Graph graph;
+	graph.MinimizeHierarchical(input, points.size());
+	return {graph.nodes(), graph.cost()};
+}
+
+// The approximate mode reports the exact cost of its sequence, and with all
+// the other nodes as candidates it is the full search.
+Solution Candidates(const std::vector<Vector<float> >& points,
+		const Solution&) {
+	AdjacencyGraph input = Generator::EuclideanGraph(points);
+	N1Graph approximate;
+	approximate.set_candidates(3);
+	approximate.Minimize(input);
+	EXPECT_EQ(approximate.cost(),
+			N1Graph::Evaluate(input, approximate.nodes()));
+	N1Graph graph;
+	graph.set_candidates(points.size() - 1);
+	graph.Minimize(input);
+	return {graph.nodes(), graph.cost()};
+}
+
+// A warm start on a moved point-set whose cost is far from the reference one
+// falls back to the full search, and yields the cold solution unless the
+// previous order is strictly cheaper.
+Solution FallBack(const std::vector<Vector<float> >& points,
+		const Solution& reference) {
+	std::vector<Vector<float> > moved = points;
+	for (int i = 0; i < static_cast<int>(moved.size()); ++i)
+		moved[i] = moved[i] + Vector<float>(0.25f * (i % 3), 0.5f * (i % 2));
+	AdjacencyGraph input = Generator::EuclideanGraph(moved);
+	N1Graph cold;
+	cold.Minimize(input);
+	N1Graph graph;
+	EXPECT_FALSE(graph.Minimize(input, reference.nodes,
+			2 * reference.cost + 1, 0));
+	std::vector<int> expected = cold.nodes();
+	if (N1Graph::Evaluate(input, reference.nodes) < cold.cost())
+		expected = reference.nodes;
+	if (graph.nodes() == expected)
+		return reference;
+	return {graph.nodes(), graph.cost()};
+}
+
+// Inserting the last point into the solution of the others.
+Solution Insert(const std::vector<Vector<float> >& points,
+		const Solution&) {
+	std::vector<Vector<float> > others(points.begin(), points.end() - 1);
+	AdjacencyGraph input = Generator::EuclideanGraph(others);
+	N1Graph graph;
+	graph.set_incremental(true);
+	graph.Minimize(input);
+	EXPECT_TRUE(graph.Insert(&input, points.back()));
+	return {graph.nodes(), graph.cost()};
+}
+
+// Removing an extra point placed in the middle of the point-set.
+Solution Remove(const std::vector<Vector<float> >& points,
+		const Solution&) {
+	std::vector<Vector<float> > extended = points;
+	int middle = points.size() / 2;
+	extended.insert(extended.begin() + middle, points[0] + points[middle]);
+	AdjacencyGraph input = Generator::EuclideanGraph(extended);
+	N1Graph graph;
+	graph.set_incremental(true);
+	graph.Minimize(input);
+	EXPECT_TRUE(graph.Remove(&input, middle));
+	return {graph.nodes(), graph.cost()};
+}
+
+std::vector<NamedVariant> Variants() {
+	std::vector<NamedVariant> variants;
+	variants.push_back({"rolling", std::bind(WithStrategy,
+			std::placeholders::_1, SolverStrategy::ROLLING,
+			std::placeholders::_2)});
+	variants.push_back({"auto", Auto});
+	variants.push_back({"double", std::bind(WithPrecision,
+			std::placeholders::_1, CostPrecision::DOUBLE_PRECISION, 1e-12,
+			std::placeholders::_2)});
+	variants.push_back({"fixed", std::bind(WithPrecision,
+			std::placeholders::_1, CostPrecision::FIXED_POINT, 1e-9,
+			std::placeholders::_2)});
+	variants.push_back({"small", Small});
+	variants.push_back({"async", Async});
+	variants.push_back({"resume", Resume});
+	variants.push_back({"sampled", Sampled});
+	variants.push_back({"evaluate", Evaluated});
+	variants.push_back({"warm_start", WarmStart});
+	variants.push_back({"quantized", Quantized});
+	variants.push_back({"candidates", Candidates});
+	variants.push_back({"hierarchical", Hierarchical});
+	variants.push_back({"refined", Refined});
+	variants.push_back({"fall_back", FallBack});
+	variants.push_back({"insert", Insert});
+	variants.push_back({"remove", Remove});
+	return variants;
+}
+
+bool Agrees(const Variant& variant, const std::vector<Vector<float> >& points,
+		const Solution& expected) {
+	Solution actual = variant(points, expected);
+	return expected.nodes == actual.nodes && expected.cost == actual.cost;
+}
+
+/**
+ * Removes points, first in chunks and then one by one, while the variant
+ * still disagrees with the reference.
+ */
+std::vector<Vector<float> > Shrink(const Variant& variant,
+		std::vector<Vector<float> > points) {
+	const int minimum = 4;
+	for (int chunk = points.size() / 2; chunk >= 1; chunk /= 2) {
+		bool shrunk = true;
+		while (shrunk) {
+			shrunk = false;
+			for (int start = 0; start + chunk <= static_cast<int>(points.size())
+					&& static_cast<int>(points.size()) - chunk >= minimum;
+					start += chunk) {
+				std::vector<Vector<float> > candidate = points;
+				candidate.erase(candidate.begin() + start,
+						candidate.begin() + start + chunk);
+				if (!Agrees(variant, candidate, Reference(candidate))) {
+					points = candidate;
+					shrunk = true;
+					break;
+				}
+			}
+		}
+	}
+	return points;
+}
+
+std::string ToString(const std::vector<Vector<float> >& points) {
+	std::string output;
+	for (const Vector<float>& point : points) {
+		output += std::to_string(point[0]) + "," + std::to_string(point[1])
+				+ "\n";
+	}
+	return output;
+}
+
+/**
+ * A random point-set, including the degenerate cases: duplicated points,
+ * collinear points and integer lattices with many equal distances.
+ */
+std::vector<Vector<float> > RandomPointSet(std::mt19937* engine) {
+	int n = 4 + (*engine)() % 21;
+	unsigned int seed = (*engine)();
+	switch ((*engine)() % 6) {
+	case 0:
+		return Generator::Uniform(n, 100.f, seed);
+	case 1:
+		return Generator::Blobs(n, 1 + seed % 4, 100.f, 3.f, seed);
+	case 2:
+		return Generator::RegularPolygon(n, 10.f);
+	case 3: {
+		// Duplicated points.
+		std::vector<Vector<float> > points = Generator::Uniform(
+				(n + 1) / 2, 10.f, seed);
+		while (static_cast<int>(points.size()) < n)
+			points.push_back(points[(*engine)() % points.size()]);
+		return points;
+	}
+	case 4: {
+		// Collinear points with integer spacing.
+		std::vector<Vector<float> > points;
+		for (int i = 0; i < n; ++i)
+			points.push_back(Vector<float>((*engine)() % 16, 3.f));
+		return points;
+	}
+	default: {
+		// Integer lattice.
+		std::vector<Vector<float> > points;
+		for (int i = 0; i < n; ++i)
+			points.push_back(Vector<float>((*engine)() % 5, (*engine)() % 5));
+		return points;
+	}
+	}
+}
+
+int Iterations() {
+	const char* iterations = std::getenv("N1GRAPH_DIFFERENTIAL_ITERATIONS");
+	return iterations ? std::atoi(iterations) : 2000;
+}
+
+}  // namespace
+
+TEST(DifferentialTest, VariantsMatchReference) {
+	std::vector<NamedVariant> variants = Variants();
+	std::mt19937 engine(2015);
+	for (int iteration = 0; iteration < Iterations(); ++iteration) {
+		std::vector<Vector<float> > points = RandomPointSet(&engine);
+		Solution reference = Reference(points);
+		for (const NamedVariant& variant : variants) {
+			if (Agrees(variant.solve, points, reference))
+				continue;
+			std::vector<Vector<float> > minimal = Shrink(variant.solve,
+					points);
+			FAIL() << "Variant " << variant.name << " disagrees with the "
+					<< "reference on iteration " << iteration
+					<< ", minimal point-set:\n" << ToString(minimal);
+		}
+	}
+}
@@ -0,0 +1,199 @@
+/*
+ * Copyright 2014 Samuel de Sousa
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <executor.hpp>
+
+#include <algorithm>
+#include <atomic>
+
+#include <glog/logging.h>
+
+namespace n1graph {
+
+namespace {
+
+// The executor set by Executor::SetDefault.
+std::atomic<Executor*> default_executor(nullptr);
+
+// The pool and the index of the worker running on this thread, if any.
+thread_local const ThreadPool* worker_pool = nullptr;
+thread_local int worker_index = -1;
+
+// The indices of a ParallelFor shared by the caller and the helper tasks. A
+// helper may start after the caller returned, therefore it holds the state.
+struct ParallelForState {
+	std::atomic<int> next_;
+	std::atomic<int> done_;
+	int end_;
+	int total_;
+	const std::function<void(int)>* body_;
+	std::mutex mutex_;
+	std::condition_variable finished_;
+};
+
+void RunIndices(const std::shared_ptr<ParallelForState>& state) {
+	int i;
+	while ((i = state->next_.fetch_add(1)) < state->end_) {
+		(*state->body_)(i);
+		if (state->done_.fetch_add(1) + 1 == state->total_) {
+			std::lock_guard<std::mutex> lock(state->mutex_);
+			state->finished_.notify_all();
+		}
+	}
+}
+
+}  // namespace
+
+void Executor::ParallelFor(int begin, int end,
+		const std::function<void(int)>& body) {
+	if (begin >= end)
+		return;
+	std::shared_ptr<ParallelForState> state =
+			std::make_shared<ParallelForState>();
+	state->next_ = begin;
+	state->done_ = 0;
+	state->end_ = end;
+	state->total_ = end - begin;
+	state->body_ = &body;
+	int helpers = std::min(concurrency(), end - begin) - 1;
+	for (int h = 0; h < helpers; ++h) {
+		Submit([state]() {
+			RunIndices(state);
+		});
+	}
+	RunIndices(state);
+	// The indices claimed by the helpers are still running. The helpers which
+	// have not started will find no index left.
+	std::unique_lock<std::mutex> lock(state->mutex_);
+	state->finished_.wait(lock, [&state]() {
+		return state->done_.load() == state->total_;
+	});
+}
+
+Executor* Executor::Default() {
+	Executor* executor = default_executor.load();
+	if (executor != nullptr)
+		return executor;
+	static ThreadPool pool(std::max(1u, std::thread::hardware_concurrency()));
+	return &pool;
+}
+
+void Executor::SetDefault(Executor* executor) {
+	default_executor.store(executor);
+}
+
+ThreadPool::ThreadPool(int threads) :
+		queued_(0), pending_(0), next_queue_(0), stop_(false) {
+	CHECK_GT(threads, 0);
+	for (int t = 0; t < threads; ++t) {
+		queues_.emplace_back(new Queue());
+	}
+	for (int t = 0; t < threads; ++t) {
+		threads_.emplace_back(&ThreadPool::Work, this, t);
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	Wait();
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		stop_ = true;
+	}
+	work_.notify_all();
+	for (std::thread& thread : threads_) {
+		thread.join();
+	}
+}
+
+void ThreadPool::Submit(std::function<void()> task) {
+	int queue;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		++pending_;
+		queue = worker_pool == this ?
+				worker_index : next_queue_++ % queues_.size();
+	}
+	{
+		std::lock_guard<std::mutex> lock(queues_[queue]->mutex_);
+		queues_[queue]->tasks_.push_back(std::move(task));
+	}
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		++queued_;
+	}
+	work_.notify_one();
+}
+
+void ThreadPool::Wait() {
+	CHECK(worker_pool != this) << "Wait must not be called from a task.";
+	std::unique_lock<std::mutex> lock(mutex_);
+	idle_.wait(lock, [this]() {
+		return pending_ == 0;
+	});
+}
+
+bool ThreadPool::Take(int worker, std::function<void()>* task) {
+	{
+		Queue* own = queues_[worker].get();
+		std::lock_guard<std::mutex> lock(own->mutex_);
+		if (!own->tasks_.empty()) {
+			*task = std::move(own->tasks_.back());
+			own->tasks_.pop_back();
+			return true;
+		}
+	}
+	for (size_t k = 1; k < queues_.size(); ++k) {
+		Queue* victim = queues_[(worker + k) % queues_.size()].get();
+		std::lock_guard<std::mutex> lock(victim->mutex_);
+		if (!victim->tasks_.empty()) {
+			*task = std::move(victim->tasks_.front());
+			victim->tasks_.pop_front();
+			return true;
+		}
+	}
+	return false;
+}
+
+void ThreadPool::Work(int worker) {
+	worker_pool = this;
+	worker_index = worker;
+	std::function<void()> task;
+	while (true) {
+		if (Take(worker, &task)) {
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				--queued_;
+			}
+			task();
+			task = nullptr;
+			std::lock_guard<std::mutex> lock(mutex_);
+			if (--pending_ == 0)
+				idle_.notify_all();
+			continue;
+		}
+		std::unique_lock<std::mutex> lock(mutex_);
+		// A task may be in the middle of being pushed, in which case the
+		// worker looks again.
+		work_.wait(lock, [this]() {
+			return stop_ || queued_ > 0;
+		});
+		if (stop_ && queued_ == 0)
+			return;
+	}
+}
+
+} /* namespace n1graph */
@@ -0,0 +1,148 @@
+/*
+ * Copyright 2014 Samuel de Sousa
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef EXECUTOR_HPP_
+#define EXECUTOR_HPP_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace n1graph {
+
+/**
+ * The interface through which all the parallelism of the library runs, so
+ * that an embedder which owns its threads can run the library on them. A
+ * component uses the executor it is given, or Executor::Default() when it is
+ * given none.
+ */
+class Executor {
+public:
+	virtual ~Executor() {
+	}
+
+	/**
+	 * Schedules a task, which may run on any thread, including the caller.
+	 */
+	virtual void Submit(std::function<void()> task) = 0;
+
+	/**
+	 * Blocks until every task submitted so far has finished. It must not be
+	 * called from a task.
+	 */
+	virtual void Wait() = 0;
+
+	/**
+	 * The number of tasks which may run at the same time.
+	 */
+	virtual int concurrency() const = 0;
+
+	/**
+	 * Runs body(i) for each i in [begin, end) and returns when all of them
+	 * have finished. The indices are claimed one at a time by the caller and
+	 * by up to concurrency() - 1 submitted tasks. Since the caller takes part,
+	 * it may be called from a task, e.g. a Minimize run by a Gallery query.
+	 */
+	virtual void ParallelFor(int begin, int end,
+			const std::function<void(int)>& body);
+
+	/**
+	 * Returns the executor set by SetDefault or, if none, an internal
+	 * ThreadPool with one thread per core, which is created on first use.
+	 */
+	static Executor* Default();
+
+	/**
+	 * Replaces the default executor of the process. nullptr restores the
+	 * internal pool. The executor must outlive its use by the library.
+	 */
+	static void SetDefault(Executor* executor);
+};
+
+/**
+ * Runs every task on the calling thread.
+ */
+class InlineExecutor: public Executor {
+public:
+	void Submit(std::function<void()> task) override {
+		task();
+	}
+
+	void Wait() override {
+	}
+
+	int concurrency() const override {
+		return 1;
+	}
+};
+
+/**
+ * A work-stealing pool. Each worker has its own queue: the tasks submitted
+ * by a worker go to its queue, the others are spread over the queues. A
+ * worker runs the newest task of its queue, or steals the oldest task of
+ * another queue.
+ */
+class ThreadPool: public Executor {
+public:
+	explicit ThreadPool(int threads);
+
+	void Submit(std::function<void()> task) override;
+
+	void Wait() override;
+
+	int concurrency() const override {
+		return threads_.size();
+	}
+
+	/**
+	 * Waits for the submitted tasks and stops the workers.
+	 */
+	virtual ~ThreadPool();
+
+private:
+	struct Queue {
+		std::mutex mutex_;
+		std::deque<std::function<void()> > tasks_;
+	};
+
+	// The loop of a worker.
+	void Work(int worker);
+
+	// Takes a task from the queue of worker or, if it is empty, steals one.
+	bool Take(int worker, std::function<void()>* task);
+
+	std::vector<std::unique_ptr<Queue> > queues_;
+	std::vector<std::thread> threads_;
+
+	// It guards the counters below and backs the condition variables.
+	std::mutex mutex_;
+	std::condition_variable work_;
+	std::condition_variable idle_;
+	// The tasks waiting in a queue, and the ones either waiting or running.
+	int queued_;
+	int pending_;
+	// The queue of the next task submitted from outside the pool.
+	unsigned int next_queue_;
+	bool stop_;
+};
+
+} /* namespace n1graph */
+#endif /* EXECUTOR_HPP_ */
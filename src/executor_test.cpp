@@ -0,0 +1,120 @@
+/*
+ * Copyright 2014 Samuel de Sousa
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <executor.hpp>
+
+using namespace n1graph;
+
+namespace {
+
+// Runs body(executor) on an inline executor and on pools of several sizes.
+template<class Body>
+void ForEachExecutor(Body body) {
+	InlineExecutor inline_executor;
+	body(&inline_executor);
+	for (int threads : { 1, 2, 8 }) {
+		ThreadPool pool(threads);
+		body(&pool);
+	}
+}
+
+}  // namespace
+
+TEST(ExecutorTest, EmptyRange) {
+	ForEachExecutor([](Executor* executor) {
+		std::atomic<int> calls(0);
+		executor->ParallelFor(3, 3, [&calls](int) {
+			++calls;
+		});
+		EXPECT_EQ(calls.load(), 0);
+	});
+}
+
+TEST(ExecutorTest, RangeSmallerThanThreads) {
+	ForEachExecutor([](Executor* executor) {
+		std::vector<std::atomic<int> > calls(3);
+		for (std::atomic<int>& count : calls)
+			count = 0;
+		executor->ParallelFor(0, calls.size(), [&calls](int i) {
+			++calls[i];
+		});
+		for (std::atomic<int>& count : calls)
+			EXPECT_EQ(count.load(), 1);
+	});
+}
+
+// The inner loops run while the workers are busy with the outer one, which
+// only finishes because the callers take part in their loops.
+TEST(ExecutorTest, NestedParallelFor) {
+	ForEachExecutor([](Executor* executor) {
+		const int outer = 16;
+		const int inner = 32;
+		std::vector<std::atomic<int> > calls(outer * inner);
+		for (std::atomic<int>& count : calls)
+			count = 0;
+		executor->ParallelFor(0, outer, [&](int i) {
+			executor->ParallelFor(0, inner, [&](int j) {
+				++calls[i * inner + j];
+			});
+		});
+		for (std::atomic<int>& count : calls)
+			EXPECT_EQ(count.load(), 1);
+	});
+}
+
+TEST(ExecutorTest, WaitRunsEveryTask) {
+	ThreadPool pool(4);
+	std::atomic<int> calls(0);
+	for (int i = 0; i < 1000; ++i) {
+		pool.Submit([&calls]() {
+			++calls;
+		});
+	}
+	pool.Wait();
+	EXPECT_EQ(calls.load(), 1000);
+}
+
+// The tasks submitted by a blocked worker go to its own queue, therefore they
+// only run if the other workers steal them.
+TEST(ExecutorTest, IdleWorkersSteal) {
+	ThreadPool pool(4);
+	std::atomic<int> stolen(0);
+	std::atomic<bool> finished(false);
+	pool.Submit([&]() {
+		for (int i = 0; i < 3; ++i) {
+			pool.Submit([&stolen]() {
+				++stolen;
+			});
+		}
+		std::chrono::steady_clock::time_point deadline =
+				std::chrono::steady_clock::now() + std::chrono::seconds(10);
+		while (stolen.load() < 3 && std::chrono::steady_clock::now() < deadline)
+			std::this_thread::yield();
+		finished = true;
+	});
+	pool.Wait();
+	EXPECT_TRUE(finished.load());
+	EXPECT_EQ(stolen.load(), 3);
+}
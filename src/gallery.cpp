@@ -0,0 +1,128 @@
+/*
+ * Copyright 2014 Samuel de Sousa
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <gallery.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+#include <glog/logging.h>
+
+#include <stats.hpp>
+#include <tracer.hpp>
+
+namespace n1graph {
+
+Gallery::Gallery() {
+}
+
+Gallery::~Gallery() {
+}
+
+int Gallery::Add(const AdjacencyGraph& input) {
+	N1Graph graph;
+	graph.Minimize(input);
+	return Add(graph);
+}
+
+int Gallery::Add(const N1Graph& graph) {
+	CHECK_EQ(graph.nodes().size(), graph.result().NumberOfNodes());
+	Entry entry;
+	entry.order_ = graph.nodes();
+	entry.location_ = graph.result().location();
+	int index = entries_.size();
+	buckets_[entry.order_.size()].push_back(index);
+	entries_.push_back(entry);
+	return index;
+}
+
+const std::vector<int>& Gallery::Bucket(int number_of_points) const {
+	std::map<int, std::vector<int> >::const_iterator bucket = buckets_.find(
+			number_of_points);
+	if (bucket == buckets_.end())
+		return empty_bucket_;
+	return bucket->second;
+}
+
+std::vector<GalleryMatch> Gallery::Query(const N1Graph& query,
+		Executor* executor) const {
+	return Query(query, Bucket(query.nodes().size()), executor);
+}
+
+std::vector<GalleryMatch> Gallery::Query(const N1Graph& query,
+		const std::vector<int>& entries, Executor* executor) const {
+	ScopedTimer timer(StatsPhase::REGISTER);
+	ScopedTrace trace(StatsPhase::REGISTER);
+	const std::vector<int>& order = query.nodes();
+	int n = order.size();
+	CHECK_EQ(n, query.result().NumberOfNodes());
+	// Position of each query node in its join/isolate sequence.
+	std::vector<int> rank(n);
+	for (int i = 0; i < n; ++i) {
+		rank[order[i]] = i;
+	}
+	// The pairwise distances of the query are shared by all entries.
+	std::vector<float> distance(static_cast<size_t>(n) * n);
+	for (int i = 0; i < n; ++i) {
+		for (int j = 0; j < n; ++j) {
+			distance[static_cast<size_t>(i) * n + j] = (query.result().location(i)
+					- query.result().location(j)).Norm();
+		}
+	}
+
+	std::vector<int> candidates;
+	for (int entry : entries) {
+		CHECK_GE(entry, 0);
+		CHECK_LT(entry, static_cast<int>(entries_.size()));
+		if (static_cast<int>(entries_[entry].order_.size()) == n)
+			candidates.push_back(entry);
+	}
+
+	std::vector<GalleryMatch> matches(candidates.size());
+	if (executor == nullptr)
+		executor = Executor::Default();
+	executor->ParallelFor(0, candidates.size(), [&](int c) {
+		const Entry& entry = entries_[candidates[c]];
+		GalleryMatch& match = matches[c];
+		match.entry_ = candidates[c];
+		match.correspondence_.resize(n);
+		// Nodes in the same position of the sequences have the same degree.
+		for (int i = 0; i < n; ++i) {
+			match.correspondence_[i] = entry.order_[rank[i]];
+		}
+		double error = 0;
+		for (int i = 0; i < n; ++i) {
+			const Vector<float>& location_i =
+					entry.location_[match.correspondence_[i]];
+			for (int j = i + 1; j < n; ++j) {
+				double d = (location_i
+						- entry.location_[match.correspondence_[j]]).Norm();
+				d -= distance[static_cast<size_t>(i) * n + j];
+				error += d * d;
+			}
+		}
+		int64_t pairs = static_cast<int64_t>(n) * (n - 1) / 2;
+		match.score_ = pairs > 0 ? std::sqrt(error / pairs) : 0;
+	});
+	std::stable_sort(matches.begin(), matches.end(),
+			[](const GalleryMatch& first, const GalleryMatch& second) {
+				return first.score_ < second.score_;
+			});
+	return matches;
+}
+
+} /* namespace n1graph */
@@ -0,0 +1,133 @@
+/*
+ * Copyright 2014 Samuel de Sousa
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef GALLERY_HPP_
+#define GALLERY_HPP_
+
+#include <map>
+#include <vector>
+
+#include <adjacency_graph.hpp>
+#include <executor.hpp>
+#include <n1graph.hpp>
+
+namespace n1graph {
+
+/**
+ * The outcome of registering a query against one entry of the gallery.
+ */
+struct GalleryMatch {
+	// The index of the gallery entry.
+	int entry_;
+	// The root mean square difference of the pairwise distances under the
+	// correspondence. Lower is better, zero means the two point sets are
+	// congruent.
+	float score_;
+	// For each node of the query, the corresponding node of the entry.
+	std::vector<int> correspondence_;
+};
+
+/**
+ * An index of G_N templates used for one-to-many registration. The
+ * join/isolate ordering of each template is computed once when it is added,
+ * therefore a query only pays for its own Minimize and an O(V^2) scoring per
+ * entry.
+ */
+class Gallery {
+public:
+	Gallery();
+
+	/**
+	 * Minimizes the point-set and stores its G_N ordering.
+	 *
+	 * Time Complexity: the one of N1Graph::Minimize.
+	 *
+	 * @param input: The complete graph of the template point-set.
+	 * @return the index of the new entry.
+	 */
+	int Add(const AdjacencyGraph& input);
+
+	/**
+	 * Stores the ordering of an already minimized template.
+	 *
+	 * Time Complexity: O(V)
+	 *
+	 * @param graph: The G_N graph of the template.
+	 * @return the index of the new entry.
+	 */
+	int Add(const N1Graph& graph);
+
+	/**
+	 * Registers the query against every entry with the same number of
+	 * points. The entries are registered in parallel.
+	 *
+	 * Time Complexity: O(K * V^2) for K entries in the bucket.
+	 *
+	 * @param query: The minimized G_N graph of the query.
+	 * @param executor: The executor of the parallel loop, nullptr for
+	 * Executor::Default().
+	 * @return the matches sorted by increasing score.
+	 */
+	std::vector<GalleryMatch> Query(const N1Graph& query, Executor* executor =
+			nullptr) const;
+
+	/**
+	 * Registers the query against a subset of the entries. Entries whose
+	 * number of points differ from the query are ignored.
+	 *
+	 * Time Complexity: O(K * V^2) for K entries in the subset.
+	 *
+	 * @param query: The minimized G_N graph of the query.
+	 * @param entries: The indices of the entries to be registered.
+	 * @param executor: The executor of the parallel loop, nullptr for
+	 * Executor::Default().
+	 * @return the matches sorted by increasing score.
+	 */
+	std::vector<GalleryMatch> Query(const N1Graph& query,
+			const std::vector<int>& entries,
+			Executor* executor = nullptr) const;
+
+	/**
+	 * Returns the indices of the entries with the given number of points.
+	 */
+	const std::vector<int>& Bucket(int number_of_points) const;
+
+	size_t size() const {
+		return entries_.size();
+	}
+
+	virtual ~Gallery();
+
+private:
+	struct Entry {
+		// The join/isolate ordering of the template.
+		std::vector<int> order_;
+		// The location of each node of the template.
+		std::vector<Vector<float> > location_;
+	};
+
+	std::vector<Entry> entries_;
+
+	// The entries indexed by their number of points.
+	std::map<int, std::vector<int> > buckets_;
+
+	// Returned for a number of points which is not in the gallery.
+	std::vector<int> empty_bucket_;
+};
+
+} /* namespace n1graph */
+#endif /* GALLERY_HPP_ */
@@ -0,0 +1,49 @@
+/*
+ * Copyright 2014 Samuel de Sousa
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "gtest/gtest.h"
+
+#include <vector>
+
+#include <generator.hpp>
+#include <gallery.hpp>
+#include <n1graph.hpp>
+
+using namespace n1graph;
+
+TEST(GalleryTest, QueryIsItsOwnBestMatch) {
+	Gallery gallery;
+	std::vector<N1Graph> templates(4);
+	for (int i = 0; i < static_cast<int>(templates.size()); ++i) {
+		templates[i].Minimize(Generator::EuclideanGraph(
+				Generator::Uniform(12, 100.f, 100 + i)));
+		EXPECT_EQ(gallery.Add(templates[i]), i);
+	}
+	// An entry of another size is not registered.
+	gallery.Add(Generator::EuclideanGraph(Generator::Uniform(8, 100.f, 7)));
+	EXPECT_EQ(gallery.Bucket(12).size(), templates.size());
+	for (int i = 0; i < static_cast<int>(templates.size()); ++i) {
+		std::vector<GalleryMatch> matches = gallery.Query(templates[i]);
+		ASSERT_EQ(matches.size(), templates.size());
+		EXPECT_EQ(matches[0].entry_, i);
+		EXPECT_NEAR(matches[0].score_, 0, 1e-4);
+		for (int node = 0; node < 12; ++node)
+			EXPECT_EQ(matches[0].correspondence_[node], node);
+		for (size_t k = 1; k < matches.size(); ++k)
+			EXPECT_LE(matches[k - 1].score_, matches[k].score_);
+	}
+}
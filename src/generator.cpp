@@ -0,0 +1,117 @@
+/*
+ * Copyright 2014 Samuel de Sousa
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <generator.hpp>
+
+#include <cmath>
+#include <functional>
+#include <random>
+
+#include <glog/logging.h>
+
+#include <stats.hpp>
+#include <tracer.hpp>
+
+namespace n1graph {
+
+namespace {
+
+// The smaller point-sets are not worth spreading over threads.
+const int kParallelPoints = 1024;
+
+// The distributions of the standard library are implementation defined,
+// therefore we only rely on the raw output of the engine.
+float NextUniform(std::mt19937* engine) {
+	return ((*engine)() >> 8) * (1.f / 16777216.f);
+}
+
+}  // namespace
+
+std::vector<Vector<float> > Generator::Uniform(int n, float size,
+		unsigned int seed) {
+	CHECK_GE(n, 0);
+	std::mt19937 engine(seed);
+	std::vector<Vector<float> > points;
+	for (int i = 0; i < n; ++i) {
+		float x = size * NextUniform(&engine);
+		float y = size * NextUniform(&engine);
+		points.push_back(Vector<float>(x, y));
+	}
+	return points;
+}
+
+std::vector<Vector<float> > Generator::Blobs(int n, int clusters, float size,
+		float spread, unsigned int seed) {
+	CHECK_GE(n, 0);
+	CHECK_GT(clusters, 0);
+	std::vector<Vector<float> > centers = Uniform(clusters, size, seed);
+	std::mt19937 engine(seed + 1);
+	std::vector<Vector<float> > points;
+	for (int i = 0; i < n; ++i) {
+		const Vector<float>& center = centers[i % clusters];
+		// Box-Muller transform.
+		float u = 1.f - NextUniform(&engine);
+		float v = NextUniform(&engine);
+		float radius = spread * std::sqrt(-2.f * std::log(u));
+		float x = center[0] + radius * std::cos(2.f * M_PI * v);
+		float y = center[1] + radius * std::sin(2.f * M_PI * v);
+		points.push_back(Vector<float>(x, y));
+	}
+	return points;
+}
+
+std::vector<Vector<float> > Generator::RegularPolygon(int n, float radius) {
+	CHECK_GT(n, 0);
+	std::vector<Vector<float> > points;
+	float angle = 360.f / n;
+	for (int i = 0; i < n; ++i) {
+		float radian_angle = i * angle * M_PI / 180;
+		float x = radius * cos(radian_angle);
+		float y = radius * sin(radian_angle);
+		points.push_back(Vector<float>(x, y));
+	}
+	return points;
+}
+
+AdjacencyGraph Generator::EuclideanGraph(
+		const std::vector<Vector<float> >& points, Executor* executor) {
+	ScopedTimer timer(StatsPhase::BUILD_INPUT);
+	ScopedTrace trace(StatsPhase::BUILD_INPUT);
+	AdjacencyGraph adj(points.size(), GraphType::UNDIRECTED, 0.f);
+	int n = points.size();
+	for (int i = 0; i < n; ++i) {
+		adj.SetLocation(i, points[i]);
+	}
+	// Each row writes its own upper triangle and the mirrored column.
+	std::function<void(int)> row = [&](int i) {
+		for (int j = i + 1; j < n; ++j) {
+			adj.AddEuclideanWeightedEdge(i, j);
+		}
+	};
+	if (n < kParallelPoints) {
+		for (int i = 0; i < n; ++i) {
+			row(i);
+		}
+	} else {
+		if (executor == nullptr)
+			executor = Executor::Default();
+		executor->ParallelFor(0, n, row);
+	}
+	return adj;
+}
+
+} /* namespace n1graph */
@@ -0,0 +1,81 @@
+/*
+ * Copyright 2014 Samuel de Sousa
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef GENERATOR_HPP_
+#define GENERATOR_HPP_
+
+#include <vector>
+
+#include <adjacency_graph.hpp>
+#include <executor.hpp>
+#include <vector.hpp>
+
+namespace n1graph {
+
+/**
+ * Deterministic synthetic point-sets used by the demo, the benchmarks and the
+ * tests. The same seed yields the same points on every platform.
+ */
+class Generator {
+private:
+	Generator() {
+	}
+public:
+	/**
+	 * Points drawn uniformly from the square [0, size) x [0, size).
+	 *
+	 * Time Complexity: O(V)
+	 */
+	static std::vector<Vector<float> > Uniform(int n, float size,
+			unsigned int seed);
+
+	/**
+	 * Points drawn from isotropic Gaussian blobs whose centers are uniform in
+	 * the square [0, size) x [0, size).
+	 *
+	 * Time Complexity: O(V)
+	 *
+	 * @param clusters: The number of blobs.
+	 * @param spread: The standard deviation of each blob.
+	 */
+	static std::vector<Vector<float> > Blobs(int n, int clusters, float size,
+			float spread, unsigned int seed);
+
+	/**
+	 * The vertices of a regular polygon centered at the origin.
+	 *
+	 * Time Complexity: O(V)
+	 */
+	static std::vector<Vector<float> > RegularPolygon(int n, float radius);
+
+	/**
+	 * The complete undirected graph of a point-set weighted by the Euclidean
+	 * distance, which is the input expected by N1Graph::Minimize. The rows of
+	 * large point-sets are computed in parallel.
+	 *
+	 * Time Complexity: O(V^2)
+	 *
+	 * @param executor: The executor of the parallel loop, nullptr for
+	 * Executor::Default().
+	 */
+	static AdjacencyGraph EuclideanGraph(
+			const std::vector<Vector<float> >& points, Executor* executor =
+					nullptr);
+};
+
+} /* namespace n1graph */
+#endif /* GENERATOR_HPP_ */
@@ -0,0 +1,166 @@
+/*
+ * Copyright 2014 Samuel de Sousa
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <local_search.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#include <glog/logging.h>
+
+namespace n1graph {
+
+namespace {
+
+// The moves evaluated between two reads of the clock.
+const int kClockInterval = 1024;
+
+// The relative decrease of the cost below which a move is a rounding error.
+const double kTolerance = 1e-12;
+
+}  // namespace
+
+LocalSearch::LocalSearch(const Matrix<float>& distances,
+		const std::vector<int>& nodes) :
+		distances_(distances), nodes_(nodes), prefix_(nodes.size(), 0), cost_(
+				0) {
+	int n = nodes_.size();
+	CHECK_EQ(n, distances_.rows());
+	for (int k = 0; k < n; ++k) {
+		for (int j = 0; j < k; ++j) {
+			prefix_[k] += distances_(nodes_[k], nodes_[j]);
+		}
+		cost_ += Cost(k, nodes_[k], prefix_[k], k > 0 ? nodes_[k - 1] : -1);
+	}
+}
+
+double LocalSearch::Cost(int position, int node, double prefix,
+		int previous) const {
+	if (position == 0)
+		return 0;
+	// Odd positions isolate the node with the previous one, even ones join it
+	// to all the previous ones.
+	if (position % 2 == 1)
+		return distances_(node, previous);
+	return prefix;
+}
+
+double LocalSearch::Delta(Move move, int from, int to,
+		std::vector<int>* nodes, std::vector<double>* prefix) const {
+	int lo = std::min(from, to);
+	int hi = std::max(from, to);
+	int x = nodes_[from];
+	nodes->assign(nodes_.begin() + lo, nodes_.begin() + hi + 1);
+	prefix->assign(prefix_.begin() + lo, prefix_.begin() + hi + 1);
+	std::vector<int>& window = *nodes;
+	std::vector<double>& sums = *prefix;
+	if (move == SWAP) {
+		int y = nodes_[hi];
+		// The nodes in between see y before them instead of x.
+		double low = prefix_[hi] - distances_(y, x);
+		double high = prefix_[lo] + distances_(x, y);
+		for (int k = lo + 1; k < hi; ++k) {
+			// The difference is taken in double, like the prefix sums.
+			sums[k - lo] += static_cast<double>(distances_(nodes_[k], y))
+					- distances_(nodes_[k], x);
+			low -= distances_(y, nodes_[k]);
+			high += distances_(x, nodes_[k]);
+		}
+		std::swap(window.front(), window.back());
+		sums.front() = low;
+		sums.back() = high;
+	} else if (from < to) {
+		// The nodes in between move down and no longer see x.
+		double moved = prefix_[from];
+		for (int k = from + 1; k <= to; ++k) {
+			window[k - 1 - lo] = nodes_[k];
+			sums[k - 1 - lo] = prefix_[k] - distances_(nodes_[k], x);
+			moved += distances_(x, nodes_[k]);
+		}
+		window.back() = x;
+		sums.back() = moved;
+	} else {
+		// The nodes in between move up and see x before them.
+		double moved = prefix_[from];
+		for (int k = hi - 1; k >= lo; --k) {
+			window[k + 1 - lo] = nodes_[k];
+			sums[k + 1 - lo] = prefix_[k] + distances_(nodes_[k], x);
+			moved -= distances_(x, nodes_[k]);
+		}
+		window.front() = x;
+		sums.front() = moved;
+	}
+	double delta = 0;
+	for (int k = lo; k <= hi; ++k) {
+		delta += Cost(k, window[k - lo], sums[k - lo],
+				k == lo ? (k > 0 ? nodes_[k - 1] : -1) : window[k - lo - 1]);
+		delta -= Cost(k, nodes_[k], prefix_[k], k > 0 ? nodes_[k - 1] : -1);
+	}
+	// The isolate after the window depends on its last node.
+	if (hi + 1 < static_cast<int>(nodes_.size()) && (hi + 1) % 2 == 1) {
+		delta += static_cast<double>(distances_(nodes_[hi + 1], window.back()))
+				- distances_(nodes_[hi + 1], nodes_[hi]);
+	}
+	return delta;
+}
+
+int LocalSearch::Run(int max_moves, double seconds) {
+	int n = nodes_.size();
+	std::chrono::steady_clock::time_point start =
+			std::chrono::steady_clock::now();
+	std::vector<int> window;
+	std::vector<double> sums;
+	int moves = 0;
+	int evaluated = 0;
+	bool improved = true;
+	while (improved) {
+		improved = false;
+		for (int from = 0; from < n; ++from) {
+			for (int to = 0; to < n; ++to) {
+				if (to == from)
+					continue;
+				for (Move move : { SWAP, RELOCATE }) {
+					// A swap is symmetric, and a relocation to the next
+					// position is a swap.
+					if ((move == SWAP && to < from)
+							|| (move == RELOCATE && std::abs(to - from) == 1))
+						continue;
+					if (seconds > 0 && ++evaluated % kClockInterval == 0
+							&& std::chrono::duration<double>(
+									std::chrono::steady_clock::now() - start).count()
+									>= seconds)
+						return moves;
+					double delta = Delta(move, from, to, &window, &sums);
+					if (delta >= -kTolerance * cost_)
+						continue;
+					int lo = std::min(from, to);
+					std::copy(window.begin(), window.end(), nodes_.begin() + lo);
+					std::copy(sums.begin(), sums.end(), prefix_.begin() + lo);
+					cost_ += delta;
+					improved = true;
+					if (++moves == max_moves)
+						return moves;
+				}
+			}
+		}
+	}
+	VLOG(1) << "[LocalSearch] " << moves << " moves, cost " << cost_;
+	return moves;
+}
+
+} /* namespace n1graph */
@@ -0,0 +1,93 @@
+/*
+ * Copyright 2014 Samuel de Sousa
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef LOCAL_SEARCH_HPP_
+#define LOCAL_SEARCH_HPP_
+
+#include <vector>
+
+#include <matrix.hpp>
+
+namespace n1graph {
+
+/**
+ * Improves a join/isolate sequence by swapping two nodes or relocating one
+ * node, applying the first move which lowers the cost until none does or the
+ * budget is spent. The cost of a join is the sum of the distances from its
+ * node to the ones before it; these prefix sums are kept for every position,
+ * so that a move touching the positions [lo, hi] is evaluated and applied in
+ * O(hi - lo) instead of the O(V^2) of a full evaluation.
+ */
+class LocalSearch {
+public:
+	/**
+	 * @param distances: The adjacency matrix of the complete graph.
+	 * @param nodes: A join/isolate sequence of all the nodes.
+	 */
+	LocalSearch(const Matrix<float>& distances, const std::vector<int>& nodes);
+
+	/**
+	 * Runs passes over all the moves until a pass finds no improvement.
+	 *
+	 * Time Complexity: O(V^3) per pass.
+	 *
+	 * @param max_moves: The number of moves to apply, non-positive for no
+	 * limit.
+	 * @param seconds: The time to spend, non-positive for no limit.
+	 * @return the number of moves applied.
+	 */
+	int Run(int max_moves, double seconds);
+
+	const std::vector<int>& nodes() const {
+		return nodes_;
+	}
+
+	/**
+	 * Returns the cost of the sequence, accumulated in double precision.
+	 */
+	double cost() const {
+		return cost_;
+	}
+
+private:
+	enum Move {
+		SWAP,
+		RELOCATE
+	};
+
+	/**
+	 * Returns the change of the cost made by a move, and fills the nodes and
+	 * prefix sums of the positions [lo, hi] after it.
+	 */
+	double Delta(Move move, int from, int to, std::vector<int>* nodes,
+			std::vector<double>* prefix) const;
+
+	/**
+	 * The cost of a position given its node, its prefix sum and the node
+	 * before it.
+	 */
+	double Cost(int position, int node, double prefix, int previous) const;
+
+	const Matrix<float>& distances_;
+	std::vector<int> nodes_;
+	// The sum of the distances from each node to the ones before it.
+	std::vector<double> prefix_;
+	double cost_;
+};
+
+} /* namespace n1graph */
+#endif /* LOCAL_SEARCH_HPP_ */
@@ -21,61 +21,143 @@
 
 #include <adjacency_graph.hpp>
 #include <csv_reader.hpp>
+#include <executor.hpp>
+#include <generator.hpp>
 #include <matching.hpp>
+#include <memory.hpp>
 #include <n1graph.hpp>
+#include <stats.hpp>
 #include <text_writer.hpp>
+#include <tracer.hpp>
 #include <vector.hpp>
 
 using n1graph::AdjacencyGraph;
+using n1graph::AllocationPolicy;
+using n1graph::CostPrecision;
 using n1graph::CSVReader;
-using n1graph::GraphType;
+using n1graph::Executor;
+using n1graph::Generator;
 using n1graph::Matching;
+using n1graph::Memory;
 using n1graph::N1Graph;
+using n1graph::NumaPolicy;
+using n1graph::PagePolicy;
+using n1graph::SolverBudget;
+using n1graph::SolverStrategy;
+using n1graph::Stats;
+using n1graph::StatsFormat;
 using n1graph::TextWriter;
+using n1graph::Tracer;
 using n1graph::Vector;
 
-AdjacencyGraph CreateRegularGraph(int n) {
-	/***********
-	 * 4 Nodes *
-	 ***********/
-	AdjacencyGraph adj(n, GraphType::UNDIRECTED, 0.f);
+DEFINE_string(stats_output, "",
+		"If set, the timers and counters are written into this file.");
+DEFINE_bool(stats_prometheus, false,
+		"Writes the timers and counters in the Prometheus text format "
+		"instead of JSON.");
+DEFINE_string(trace_output, "",
+		"If set, a Chrome trace-event timeline is written into this file.");
+DEFINE_string(memory_output, "",
+		"If set, the current and peak bytes of each subsystem are written "
+		"into this file.");
+DEFINE_int64(memory_budget, 0,
+		"If positive, the number of bytes a run of the solver may use.");
+DEFINE_double(time_budget, 0,
+		"If positive, the number of seconds a run of the solver may take.");
+DEFINE_bool(explain, false,
+		"Logs how the solver runs on each point-set and why.");
+DEFINE_string(precision, "single",
+		"The arithmetic of the costs of the solver: single, double or fixed.");
+DEFINE_string(huge_pages, "none",
+		"The pages of the large matrices: none, transparent or explicit.");
+DEFINE_string(numa, "local",
+		"The NUMA placement of the large matrices: local, first_touch or "
+		"interleave.");
+DEFINE_bool(quantize, false,
+		"Stores the distances of the point-sets in 16 bits.");
+DEFINE_int32(leaf_size, 0,
+		"If positive, the point-sets are minimized hierarchically in leaves "
+		"of at most this many points.");
+DEFINE_double(refine_seconds, 0,
+		"If positive, the solutions are refined by local search for up to "
+		"this many seconds.");
+DEFINE_int32(compare_below, 0,
+		"The hierarchical cost of the point-sets with at most this many "
+		"points is compared with the one of the full search.");
 
-	float radius = 1.f;
-	float angle = 360.f / n;
-	for (int i = 0; i < n; ++i) {
-		float radian_angle = i * angle * M_PI / 180;
-		float x = radius * cos(radian_angle);
-		float y = radius * sin(radian_angle);
-		adj.SetLocation(i, Vector<float>(x, y));
-	}
+namespace {
 
-	for (int i = 0; i < n; ++i) {
-		for (int j = i + 1; j < n; ++j) {
-			adj.AddEuclideanWeightedEdge(i, j);
-		}
-	}
-	return adj;
+// Lets solver choose its strategy for input within the budget.
+void ApplyBudget(const AdjacencyGraph& input, N1Graph* solver) {
+	if (FLAGS_memory_budget <= 0 && FLAGS_time_budget <= 0 && !FLAGS_explain)
+		return;
+	SolverBudget budget;
+	budget.memory_bytes_ = FLAGS_memory_budget;
+	budget.seconds_ = FLAGS_time_budget;
+	solver->set_budget(budget);
+	solver->set_strategy(SolverStrategy::AUTO);
+	LOG_IF(INFO, FLAGS_explain)<< "Plan for " << input.NumberOfNodes()
+	<< " points:\n" << solver->Explain(input.NumberOfNodes()).ToString();
 }
 
-AdjacencyGraph CreateGraph(std::vector<Vector<float> > points) {
-	AdjacencyGraph adj(points.size(), GraphType::UNDIRECTED, 0.f);
-	for (int i = 0; i < points.size(); ++i) {
-		adj.SetLocation(i, points[i]);
-	}
-	for (int i = 0; i < points.size(); ++i) {
-		for (int j = i + 1; j < points.size(); ++j) {
-			adj.AddEuclideanWeightedEdge(i, j);
-		}
-	}
-	return adj;
+// Returns the allocation policy of the large matrices set by the flags.
+AllocationPolicy Placement() {
+	AllocationPolicy policy;
+	if (FLAGS_huge_pages == "transparent")
+		policy.pages_ = PagePolicy::TRANSPARENT_HUGE_PAGES;
+	else if (FLAGS_huge_pages == "explicit")
+		policy.pages_ = PagePolicy::EXPLICIT_HUGE_PAGES;
+	else
+		CHECK_EQ(FLAGS_huge_pages, "none") << "Unknown huge page policy.";
+	if (FLAGS_numa == "first_touch")
+		policy.numa_ = NumaPolicy::FIRST_TOUCH;
+	else if (FLAGS_numa == "interleave")
+		policy.numa_ = NumaPolicy::INTERLEAVE;
+	else
+		CHECK_EQ(FLAGS_numa, "local") << "Unknown NUMA policy.";
+	return policy;
 }
 
+// Minimizes input, hierarchically when a leaf size is given, then refines it.
+void Solve(const AdjacencyGraph& input, N1Graph* solver) {
+	if (FLAGS_precision == "double")
+		solver->set_precision(CostPrecision::DOUBLE_PRECISION);
+	else if (FLAGS_precision == "fixed")
+		solver->set_precision(CostPrecision::FIXED_POINT);
+	else
+		CHECK_EQ(FLAGS_precision, "single") << "Unknown precision.";
+	solver->set_allocation_policy(Placement());
+	if (FLAGS_leaf_size <= 0)
+		solver->Minimize(input);
+	else
+		solver->MinimizeHierarchical(input, FLAGS_leaf_size,
+				FLAGS_compare_below);
+	float full_cost = solver->cost() - solver->sampling_estimate().gap_;
+	if (FLAGS_refine_seconds > 0)
+		solver->Refine(input, 0, FLAGS_refine_seconds);
+	if (FLAGS_leaf_size > 0
+			&& static_cast<int>(input.NumberOfNodes()) <= FLAGS_compare_below)
+		LOG(INFO)<< "Hierarchical cost " << solver->cost() << " is "
+		<< solver->cost() / full_cost << " times the full one.";
+}
+
+}  // namespace
+
 int main(int argc, char **argv) {
+	google::ParseCommandLineFlags(&argc, &argv, true);
 	google::InitGoogleLogging(argv[0]);
+	Stats::Enable(!FLAGS_stats_output.empty());
+	Tracer::Enable(!FLAGS_trace_output.empty());
+	Memory::Enable(!FLAGS_memory_output.empty());
 	if (argc < 3) {
 		LOG(WARNING) << "We expect two points sets to be informed.";
 		return -1;
 	}
+	if (FLAGS_quantize && (FLAGS_leaf_size > 0 || FLAGS_refine_seconds > 0)) {
+		LOG(ERROR) << "--quantize cannot be combined with --leaf_size or "
+				<< "--refine_seconds, which read the float distances.";
+		return -1;
+	}
 	std::string result_location1 = "graph_result1.csv";
 	std::string result_location2 = "graph_result2.csv";
 	std::string tikz_location = "graph_result.tex";
@@ -83,11 +165,22 @@ int main(int argc, char **argv) {
 	N1Graph g_a, g_b;
 	LOG(INFO)<< "Building Graph.";
 	if (argc > 2) {
-		graph_a = CreateGraph(CSVReader::ReadCSV(argv[1], ','));
-		graph_b = CreateGraph(CSVReader::ReadCSV(argv[2], ','));
+		graph_a = Generator::EuclideanGraph(CSVReader::ReadCSV(argv[1], ','));
+		graph_b = Generator::EuclideanGraph(CSVReader::ReadCSV(argv[2], ','));
+		// The solvers write their workspaces with their own executor.
+		AllocationPolicy placement = Placement();
+		placement.executor_ = Executor::Default();
+		graph_a.set_allocation_policy(placement);
+		graph_b.set_allocation_policy(placement);
+		if (FLAGS_quantize) {
+			graph_a.Quantize();
+			graph_b.Quantize();
+		}
 		LOG(INFO)<< "Minimizing Cost Function.";
-		g_a.Minimize(graph_a);
-		g_b.Minimize(graph_b);
+		ApplyBudget(graph_a, &g_a);
+		ApplyBudget(graph_b, &g_b);
+		Solve(graph_a, &g_a);
+		Solve(graph_b, &g_b);
 		Matching matching;
 		matching.Register(g_a,g_b);
 		Vector<float> gap(25, 0);
@@ -97,10 +190,21 @@ int main(int argc, char **argv) {
         TextWriter::Write(tikz_location, matching.ToTikz(g_a, g_b, gap, 1));
 		LOG(INFO)<< "Run Visualization.";
 	} else {
-		graph_a = CreateRegularGraph(std::atoi(argv[1]));
-		g_a.Minimize(graph_a);
+		graph_a = Generator::EuclideanGraph(
+				Generator::RegularPolygon(std::atoi(argv[1]), 1.f));
+		ApplyBudget(graph_a, &g_a);
+		Solve(graph_a, &g_a);
 		TextWriter::Write(tikz_location, g_a.result().ToTikz());
 	}
+	if (!FLAGS_stats_output.empty()) {
+		Stats::Write(FLAGS_stats_output,
+				FLAGS_stats_prometheus ?
+						StatsFormat::PROMETHEUS : StatsFormat::JSON);
+	}
+	if (!FLAGS_trace_output.empty())
+		Tracer::Write(FLAGS_trace_output);
+	if (!FLAGS_memory_output.empty())
+		TextWriter::Write(FLAGS_memory_output, Memory::ToJson());
 	system("python visualize.py graph_result1.csv graph_result2.csv");
 	return 0;
 }
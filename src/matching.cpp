@@ -17,7 +17,9 @@
 #include "matching.hpp"
 
 #include <cstdlib>
-#include <cstring>
+
+#include <stats.hpp>
+#include <tracer.hpp>
 
 namespace n1graph {
 
@@ -27,37 +29,31 @@ Matching::Matching() :
 }
 
 void Matching::Register(const N1Graph& g1, const N1Graph& g2) {
-	LOG(INFO) << "Registering Point sets";
+	ScopedTimer timer(StatsPhase::REGISTER);
+	ScopedTrace trace(StatsPhase::REGISTER);
+	VLOG(1) << "Registering Point sets";
 	CHECK_GT(g1.result().NumberOfNodes(), 2);
 	CHECK_EQ(g1.result().NumberOfNodes(), g2.result().NumberOfNodes());
+	CHECK_EQ(g1.nodes().size(), g1.result().NumberOfNodes());
+	CHECK_EQ(g2.nodes().size(), g2.result().NumberOfNodes());
 	number_of_points = g1.result().NumberOfNodes();
 	g1_mapping.reset(new int[number_of_points]);
 	g2_mapping.reset(new int[number_of_points]);
 	g1_reverse_mapping.reset(new int[number_of_points]);
 	g2_reverse_mapping.reset(new int[number_of_points]);
 
-	memset(g1_mapping.get(), 0, number_of_points * sizeof(int));
-	memset(g2_mapping.get(), 0, number_of_points * sizeof(int));
-	memset(g1_reverse_mapping.get(), 0, number_of_points * sizeof(int));
-	memset(g2_reverse_mapping.get(), 0, number_of_points * sizeof(int));
-
-	// If we have an isolated node.
-	bool isolated = g1.result().NumberOfNodes() & 1;
-	LOG(INFO) << "Registering Point sets";
-	for (int i = 0; i < g1.result().NumberOfNodes(); ++i) {
-		int degree_1 = (int) g1.result().adjacency().row_sum(i);
-		int degree_2 = (int) g2.result().adjacency().row_sum(i);
-		LOG(INFO) << i << " "<< degree_1 - 1 << " " << degree_2 - 1;
-		if (!isolated) {
-			g1_mapping[i] = degree_1 - 1;
-			g1_reverse_mapping[degree_1 - 1] = i;
-			g2_mapping[i] = degree_2 - 1;
-			g2_reverse_mapping[degree_2 - 1] = i;
-		}
-	}
-	LOG(INFO) << "Mapping";
-	for (int i = 0; i < g1.result().NumberOfNodes(); ++i) {
-		LOG(INFO) << i << " "<< g1_mapping[i] << " " << g2_mapping[i];
+	// The degree of a node is given by its position in the join/isolate
+	// sequence, therefore nodes in the same position correspond. Unlike the
+	// degree itself, the position is unique for the two initial nodes (which
+	// share the same degree) and it is defined for the isolated node of an
+	// odd sized graph.
+	const std::vector<int>& g1_nodes = g1.nodes();
+	const std::vector<int>& g2_nodes = g2.nodes();
+	for (int i = 0; i < number_of_points; ++i) {
+		g1_mapping[g1_nodes[i]] = i;
+		g1_reverse_mapping[i] = g1_nodes[i];
+		g2_mapping[g2_nodes[i]] = i;
+		g2_reverse_mapping[i] = g2_nodes[i];
 	}
 }
 
@@ -71,13 +67,16 @@ int Matching::Correspondence(int graph, int point) {
 	if ( graph == 0 ) {
 		int g1_node = g1_mapping[point];
 		return g2_reverse_mapping[g1_node];
-	}else
-		return 0;
+	} else {
+		int g2_node = g2_mapping[point];
+		return g1_reverse_mapping[g2_node];
+	}
 }
 
 std::string Matching::ToTikz(const N1Graph& g1, const N1Graph& g2,
 		const Vector<float>& gap, float edge_percentage) const {
-	LOG(INFO) << "Generating Tex Code";
+	ScopedTimer timer(StatsPhase::SERIALIZE);
+	VLOG(1) << "Generating Tex Code";
 	CHECK_EQ(g1.result().NumberOfNodes(), g2.result().NumberOfNodes());
 	CHECK_GE(edge_percentage, 0);
 	CHECK_LE(edge_percentage, 1);
@@ -121,11 +120,10 @@ std::string Matching::ToTikz(const N1Graph& g1, const N1Graph& g2,
 	int edges_to_draw = g1.result().NumberOfNodes() * edge_percentage;
 
 	for (int i = 0; i < edges_to_draw; ++i) {
-		if (g1_mapping[i] == g1.result().NumberOfNodes()/2)
-			continue;
 		std::string source = std::to_string(g1_mapping[i])+"a";
 		std::string target = std::to_string(g1_mapping[i])+"b";
-		LOG(INFO) <<"Na posicao "<<i<< " tem o grau "<<source << " e o mapped to " << target;
+		VLOG(2) << "Position " << i << " has degree " << source
+				<< " mapped to " << target;
 		tex += "\t\\path[" + edge_class + "] (" + source + ") -- (" + target
 				+ ");\n";
 	}
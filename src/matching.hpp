@@ -37,7 +37,10 @@ public:
 	 * the NHDD property (defined in the paper as G_N graphs). The ggraphs need
 	 * to have the same number of points.
 	 *
-	 * Time Complexity: O(V+E)
+	 * The correspondence is read from the join/isolate sequence computed by
+	 * N1Graph::Minimize, so no degree has to be recomputed.
+	 *
+	 * Time Complexity: O(V)
 	 * Space Complexity: O(V)
 	 *
 	 * @param g1: The first graph G_N to be registered.
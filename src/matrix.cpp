@@ -17,40 +17,135 @@
 
 #include <matrix.hpp>
 #include <algorithm>
+#include <limits>
+
+#include <executor.hpp>
 
 namespace n1graph {
 
 template<class T>
 Matrix<T>::Matrix() :
-		cols_(0), rows_(0), channels_(0), initialized_(false) {
+		rows_(0), cols_(0), channels_(0), initialized_(false), subsystem_(
+				MemorySubsystem::MATRIX), accounted_(false) {
 
 }
 
 template<class T>
-Matrix<T>::Matrix(const Matrix<T>& original) {
+Matrix<T>::Matrix(const Matrix<T>& original) :
+		subsystem_(original.subsystem_), accounted_(false), policy_(
+				original.policy_) {
 	channels_ = original.channels();
 	cols_ = original.cols();
 	rows_ = original.rows();
 	initialized_ = true;
-	// Allocating the space for each channel.
-	data_.reset(new std::unique_ptr<T[]>[channels_]);
-	// Allocating the matrix in single array.
+	AllocateChannels();
+	CopyChannels(original.data_.get());
+	Account();
+}
+
+template<class T>
+Matrix<T>::Matrix(int width, int height, int n_channels, T default_value) :
+		rows_(height), cols_(width), channels_(n_channels), subsystem_(
+				MemorySubsystem::MATRIX), accounted_(false) {
+	Allocate(cols_, rows_, channels_, default_value);
+}
+
+template<class T>
+Matrix<T>::~Matrix() {
+	Unaccount();
+}
+
+template<class T>
+int64_t Matrix<T>::bytes() const {
+	return static_cast<int64_t>(rows_) * cols_ * channels_ * sizeof(T);
+}
+
+template<class T>
+void Matrix<T>::Account() {
+	accounted_ = initialized_ && Memory::Allocate(subsystem_, bytes());
+}
+
+template<class T>
+void Matrix<T>::Unaccount() {
+	if (accounted_)
+		Memory::Release(subsystem_, bytes());
+	accounted_ = false;
+}
+
+template<class T>
+void Matrix<T>::Release::operator()(T* values) const {
+	if (mapped_ > 0)
+		PageAllocator::Unmap(values, mapped_);
+	else
+		delete[] values;
+}
+
+template<class T>
+void Matrix<T>::AllocateChannels() {
+	const size_t size = static_cast<size_t>(cols_) * rows_;
+	data_.reset(new Channel[channels_]);
 	for (int c = 0; c < channels_; ++c) {
-		data_[c].reset(new T[cols_ * rows_]);
-		for (int x = 0; x < cols_ * rows_; ++x) {
-			data_[c][x] = original(x / cols_, x % cols_, c);
+		int64_t mapped = 0;
+		void* values = nullptr;
+		if (PageAllocator::Applies(policy_, size * sizeof(T)))
+			values = PageAllocator::Map(policy_, size * sizeof(T), &mapped);
+		if (values != nullptr)
+			data_[c] = Channel(static_cast<T*>(values), Release(mapped));
+		else
+			data_[c] = Channel(new T[size]);
+	}
+}
+
+template<class T>
+void Matrix<T>::FillRows(int channel,
+		const std::function<void(int row, T* values)>& fill) {
+	T* values = data_[channel].get();
+	const size_t cols = cols_;
+	if (policy_.numa_ == NumaPolicy::FIRST_TOUCH && policy_.executor_ != nullptr
+			&& PageAllocator::Applies(policy_, bytes() / channels_)) {
+		policy_.executor_->ParallelFor(0, rows_, [&](int row) {
+			fill(row, values + cols * row);
+		});
+	} else {
+		for (int row = 0; row < rows_; ++row) {
+			fill(row, values + cols * row);
 		}
 	}
 }
 
 template<class T>
-Matrix<T>::Matrix(int width, int height, int n_channels, T default_value) :
-		cols_(width), rows_(height), channels_(n_channels) {
-	Allocate(cols_, rows_, channels_, default_value);
+void Matrix<T>::CopyChannels(const Channel* source) {
+	const size_t cols = cols_;
+	for (int c = 0; c < channels_; ++c) {
+		const T* values = source[c].get();
+		FillRows(c, [values, cols](int row, T* target) {
+			std::copy(values + cols * row, values + cols * (row + 1), target);
+		});
+	}
+}
+
+template<class T>
+void Matrix<T>::set_allocation_policy(const AllocationPolicy& policy) {
+	policy_ = policy;
+	if (!initialized_)
+		return;
+	std::unique_ptr<Channel[]> previous = std::move(data_);
+	AllocateChannels();
+	CopyChannels(previous.get());
+}
+
+template<class T>
+void Matrix<T>::set_subsystem(MemorySubsystem subsystem) {
+	bool accounted = accounted_;
+	Unaccount();
+	subsystem_ = subsystem;
+	if (accounted)
+		Account();
 }
 
 template<class T>
 void Matrix<T>::Allocate(int width, int height, int channels, T default_value) {
+	Unaccount();
 	rows_ = height;
 	cols_ = width;
 	channels_ = channels;
@@ -58,72 +153,73 @@ void Matrix<T>::Allocate(int width, int height, int channels, T default_value) {
 	CHECK_GE(width, 0);
 	CHECK_GE(height, 0);
 	CHECK_GE(channels, 1);
-	// Allocating the space for each channel.
-	data_.reset(new std::unique_ptr<T[]>[channels]);
-	// Allocating the matrix in single array.
+	AllocateChannels();
 	for (int c = 0; c < channels_; ++c) {
-		data_[c].reset(new T[cols_ * rows_]);
-		for (int x = 0; x < cols_ * rows_; ++x) {
-			data_[c][x] = default_value;
-		}
+		FillRows(c, [this, default_value](int, T* values) {
+			std::fill(values, values + cols_, default_value);
+		});
 	}
+	Account();
 }
 
+// The accessors are in the inner loops, therefore their bounds are only
+// checked in debug builds.
+
 // Accessing single channel matrices.
 template<class T>
 T& Matrix<T>::operator()(const int row, const int col, const int channel) {
-	CHECK_GE(row, 0);
-	CHECK_GE(col, 0);
-	CHECK_LT(row, rows_);
-	CHECK_LT(col, cols_);
-	return data_[channel][cols_ * row + col];
+	DCHECK_GE(row, 0);
+	DCHECK_GE(col, 0);
+	DCHECK_LT(row, rows_);
+	DCHECK_LT(col, cols_);
+	return data_[channel][static_cast<size_t>(cols_) * row + col];
 }
 
 // Accessing single channel matrices in const mode.
 template<class T>
 T& Matrix<T>::operator()(const int row, const int col,
 		const int channel) const {
-	CHECK_GE(row, 0);
-	CHECK_GE(col, 0);
-	CHECK_LT(row, rows_);
-	CHECK_LT(col, cols_);
-	return data_[channel][cols_ * row + col];
+	DCHECK_GE(row, 0);
+	DCHECK_GE(col, 0);
+	DCHECK_LT(row, rows_);
+	DCHECK_LT(col, cols_);
+	return data_[channel][static_cast<size_t>(cols_) * row + col];
 }
 
 template<class T>
 T& Matrix<T>::operator()(const Vector<int>& coordinates) {
-	CHECK_GT(coordinates.length(), 0);
-	CHECK_LE(coordinates.length(), 3);
+	DCHECK_GT(coordinates.length(), 0);
+	DCHECK_LE(coordinates.length(), 3);
 	int row = coordinates[0];
 	int col = coordinates[1];
 	int channel = 0;
 	if (coordinates.length() == 3)
 		channel = coordinates[2];
-	CHECK_GE(row, 0);
-	CHECK_GE(col, 0);
-	CHECK_GE(channel, 0);
-	CHECK_LT(row, rows_);
-	CHECK_LT(col, cols_);
-	CHECK_LT(channel, channels_);
-	return data_[channel][cols_ * row + col];
+	DCHECK_GE(row, 0);
+	DCHECK_GE(col, 0);
+	DCHECK_GE(channel, 0);
+	DCHECK_LT(row, rows_);
+	DCHECK_LT(col, cols_);
+	DCHECK_LT(channel, channels_);
+	return data_[channel][static_cast<size_t>(cols_) * row + col];
 }
 
 template<class T>
 T& Matrix<T>::operator()(const Vector<int>& coordinates) const {
-	CHECK_GT(coordinates.length(), 0);
-	CHECK_LE(coordinates.length(), 3);
+	DCHECK_GT(coordinates.length(), 0);
+	DCHECK_LE(coordinates.length(), 3);
 	int row = coordinates[0];
 	int col = coordinates[1];
 	int channel = 0;
 	if (coordinates.length() == 3)
 		channel = coordinates[2];
-	CHECK_GE(row, 0);
-	CHECK_GE(col, 0);
-	CHECK_GE(channel, 0);
-	CHECK_LT(row, rows_);
-	CHECK_LT(col, cols_);
-	CHECK_LT(channel, channels_);
-	return data_[channel][cols_ * row + col];
+	DCHECK_GE(row, 0);
+	DCHECK_GE(col, 0);
+	DCHECK_GE(channel, 0);
+	DCHECK_LT(row, rows_);
+	DCHECK_LT(col, cols_);
+	DCHECK_LT(channel, channels_);
+	return data_[channel][static_cast<size_t>(cols_) * row + col];
 }
 
 template<class T>
@@ -145,7 +241,7 @@ T Matrix<T>::min_row(int row) const {
 template<class T>
 T Matrix<T>::min_col(int col) const {
 	CHECK_LT(col, cols_);
-	T min_value = std::numeric_limits<float>::max();
+	T min_value = std::numeric_limits<T>::max();
 	for (int i = 0; i < rows_; ++i) {
 		min_value = std::min(min_value, (*this)(i, col));
 	}
@@ -154,14 +250,16 @@ T Matrix<T>::min_col(int col) const {
 
 template<class T>
 int Matrix<T>::arg_min_row(int row) const {
-	// TODO(sam): Implement this method.
+	CHECK_LT(row, rows_);
+	const T* values = data_[row].get();
+	return std::min_element(values, values + cols_) - values;
 }
 
 template<class T>
 int Matrix<T>::arg_min_col(int col) const {
 	CHECK_LT(col, cols_);
 	int arg_min = -1;
-	T min_value = std::numeric_limits<float>::max();
+	T min_value = std::numeric_limits<T>::max();
 	for (int i = 0; i < rows_; ++i) {
 		T current_value = (*this)(i, col);
 		if (current_value < min_value) {
@@ -197,19 +295,15 @@ T Matrix<T>::row_sum(int row) const {
 template<class T>
 Matrix<T>& Matrix<T>::operator =(const Matrix<T>& original) {
 	if (this != &original) {
+		Unaccount();
 		channels_ = original.channels();
 		cols_ = original.cols();
 		rows_ = original.rows();
 		initialized_ = true;
-		// Allocating the space for each channel.
-		data_.reset(new std::unique_ptr<T[]>[channels_]);
-		// Allocating the matrix in single array.
-		for (int c = 0; c < channels_; ++c) {
-			data_[c].reset(new T[cols_ * rows_]);
-			for (int x = 0; x < cols_ * rows_; ++x) {
-				data_[c][x] = original(x / cols_, x % cols_, c);
-			}
-		}
+		policy_ = original.policy_;
+		AllocateChannels();
+		CopyChannels(original.data_.get());
+		Account();
 	}
 	return *this;
 }
@@ -245,6 +339,7 @@ int Matrix<T>::cols() const {
 }
 
 template class Matrix<bool> ;
+template class Matrix<uint16_t> ;
 template class Matrix<int> ;
 template class Matrix<long> ;
 template class Matrix<float> ;
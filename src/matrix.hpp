@@ -17,11 +17,13 @@
 #ifndef MATRIX_HPP_
 #define MATRIX_HPP_
 
+#include <functional>
 #include <memory>
 #include <string>
 
 #include <glog/logging.h>
 
+#include <memory.hpp>
 #include <vector.hpp>
 
 namespace n1graph {
@@ -176,7 +178,7 @@ public:
 	/**
 	 * Returns the number of rows in this matrix.
 	 *
- 	 * Time Complexity O(1).
+	 * Time Complexity O(1).
 	 *
 	 * @return The number of rows.
 	 */
@@ -185,7 +187,7 @@ public:
 	/**
 	 * Returns the number of columns in this matrix.
 	 *
- 	 * Time Complexity O(1).
+	 * Time Complexity O(1).
 	 *
 	 * @return The number of cols.
 	 */
@@ -194,7 +196,7 @@ public:
 	/**
 	 * Returns the number of channels in this matrix.
 	 *
- 	 * Time Complexity O(1).
+	 * Time Complexity O(1).
 	 *
 	 * @return The number of channels.
 	 */
@@ -207,7 +209,7 @@ public:
 	 * matrix will check for initialization and throw and error in case it has
 	 * not been yet initialized.
 	 *
- 	 * Time Complexity O(1).
+	 * Time Complexity O(1).
 	 *
 	 * @return The number of cols.
 	 */
@@ -223,11 +225,73 @@ public:
 	 */
 	std::string ToString() const;
 
-	virtual ~Matrix() {
+	/**
+	 * Sets the subsystem the buffer of this matrix is accounted to. The
+	 * default subsystem is MemorySubsystem::MATRIX.
+	 *
+	 * @param subsystem The owner of the buffer.
+	 */
+	void set_subsystem(MemorySubsystem subsystem);
+
+	/**
+	 * Returns the number of bytes held by the buffer of this matrix.
+	 *
+	 * Time Complexity O(1).
+	 */
+	int64_t bytes() const;
+
+	/**
+	 * Sets the pages and the NUMA placement of the buffers of this matrix. An
+	 * initialized matrix is moved to buffers placed under the new policy.
+	 *
+	 * Time Complexity O(N) for N the number of elements, if initialized.
+	 *
+	 * @param policy The policy of this and of the later allocations.
+	 */
+	void set_allocation_policy(const AllocationPolicy& policy);
+
+	const AllocationPolicy& allocation_policy() const {
+		return policy_;
 	}
 
+	virtual ~Matrix();
+
 private:
 
+	// Frees a channel with delete[] or, if it was mapped, with PageAllocator.
+	struct Release {
+		Release() :
+				mapped_(0) {
+		}
+
+		explicit Release(int64_t mapped) :
+				mapped_(mapped) {
+		}
+
+		void operator()(T* values) const;
+
+		int64_t mapped_;
+	};
+
+	typedef std::unique_ptr<T[], Release> Channel;
+
+	// Allocates the channels of the current dimensions under the policy.
+	void AllocateChannels();
+
+	// Copies the channels of the current dimensions from source.
+	void CopyChannels(const Channel* source);
+
+	// Writes each row of a channel through fill(row, values). The rows are
+	// spread over the executor of the policy under FIRST_TOUCH.
+	void FillRows(int channel,
+			const std::function<void(int row, T* values)>& fill);
+
+	// Accounts the current buffer in Memory.
+	void Account();
+
+	// Releases the accounting of the current buffer.
+	void Unaccount();
+
 	// The number of rows, columns, and channels.
 	int rows_;
 	int cols_;
@@ -236,8 +300,15 @@ private:
 	// It holds the state of this matrix: initialized or not.
 	bool initialized_;
 
+	// The owner of the buffer and whether it has been accounted in Memory.
+	MemorySubsystem subsystem_;
+	bool accounted_;
+
+	// How the channels are placed in memory.
+	AllocationPolicy policy_;
+
 	// The actual data being stored as a smart pointer.
-	std::unique_ptr<std::unique_ptr<T[]>[]> data_;
+	std::unique_ptr<Channel[]> data_;
 };
 
 } /* namespace n1graph */
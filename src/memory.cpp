@@ -0,0 +1,181 @@
+/*
+ * Copyright 2014 Samuel de Sousa
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <memory.hpp>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace n1graph {
+
+namespace {
+
+#ifdef __linux__
+// The mode and the flag of the NUMA system calls, which are declared by
+// libnuma rather than by the C library.
+const int kInterleave = 3;
+const int kMemsAllowed = 1 << 2;
+const int kMaxNodes = 1024;
+
+// Spreads the pages of a mapped range over the nodes the process may use.
+// The pages stay local if the kernel has no NUMA support.
+void Interleave(void* buffer, int64_t bytes) {
+#if defined(SYS_get_mempolicy) && defined(SYS_mbind)
+	unsigned long nodes[kMaxNodes / (8 * sizeof(unsigned long))] = { 0 };
+	if (syscall(SYS_get_mempolicy, nullptr, nodes, kMaxNodes, nullptr,
+			kMemsAllowed) == 0) {
+		syscall(SYS_mbind, buffer, bytes, kInterleave, nodes, kMaxNodes, 0);
+	}
+#endif
+}
+
+// Maps an anonymous range of bytes, a multiple of the huge page size,
+// aligned to a huge page so that the kernel can back all of it with them.
+void* MapAligned(int64_t bytes) {
+	const int64_t page = PageAllocator::kHugePageBytes;
+	void* raw = mmap(nullptr, bytes + page, PROT_READ | PROT_WRITE,
+			MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (raw == MAP_FAILED)
+		return nullptr;
+	char* begin = static_cast<char*>(raw);
+	char* aligned = begin + (page - reinterpret_cast<uintptr_t>(begin) % page)
+			% page;
+	if (aligned > begin)
+		munmap(begin, aligned - begin);
+	char* end = begin + bytes + page;
+	if (end > aligned + bytes)
+		munmap(aligned + bytes, end - aligned - bytes);
+	return aligned;
+}
+#endif
+
+void UpdatePeak(std::atomic<int64_t>* peak, int64_t value) {
+	int64_t previous = peak->load(std::memory_order_relaxed);
+	while (value > previous
+			&& !peak->compare_exchange_weak(previous, value,
+					std::memory_order_relaxed)) {
+	}
+}
+
+}  // namespace
+
+const int64_t PageAllocator::kHugePageBytes;
+
+bool PageAllocator::Applies(const AllocationPolicy& policy, int64_t bytes) {
+	return bytes >= policy.min_bytes_
+			&& (policy.pages_ != PagePolicy::DEFAULT_PAGES
+					|| policy.numa_ != NumaPolicy::LOCAL_NODE);
+}
+
+void* PageAllocator::Map(const AllocationPolicy& policy, int64_t bytes,
+		int64_t* mapped) {
+	*mapped = 0;
+#ifdef __linux__
+	bytes = (bytes + kHugePageBytes - 1) / kHugePageBytes * kHugePageBytes;
+	void* buffer = nullptr;
+	if (policy.pages_ == PagePolicy::EXPLICIT_HUGE_PAGES) {
+		buffer = mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+				MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+		if (buffer == MAP_FAILED)
+			buffer = nullptr;
+	}
+	if (buffer == nullptr) {
+		buffer = MapAligned(bytes);
+		if (buffer == nullptr)
+			return nullptr;
+#ifdef MADV_HUGEPAGE
+		if (policy.pages_ != PagePolicy::DEFAULT_PAGES)
+			madvise(buffer, bytes, MADV_HUGEPAGE);
+#endif
+	}
+	if (policy.numa_ == NumaPolicy::INTERLEAVE)
+		Interleave(buffer, bytes);
+	*mapped = bytes;
+	return buffer;
+#else
+	return nullptr;
+#endif
+}
+
+void PageAllocator::Unmap(void* buffer, int64_t mapped) {
+#ifdef __linux__
+	munmap(buffer, mapped);
+#endif
+}
+
+std::atomic<bool> Memory::enabled_(false);
+std::atomic<int64_t> Memory::current_[NUMBER_OF_SUBSYSTEMS];
+std::atomic<int64_t> Memory::peak_[NUMBER_OF_SUBSYSTEMS];
+std::atomic<int64_t> Memory::total_(0);
+std::atomic<int64_t> Memory::total_peak_(0);
+
+bool Memory::Allocate(MemorySubsystem subsystem, int64_t bytes) {
+	if (!enabled())
+		return false;
+	int64_t current = current_[subsystem].fetch_add(bytes,
+			std::memory_order_relaxed) + bytes;
+	UpdatePeak(&peak_[subsystem], current);
+	int64_t total = total_.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+	UpdatePeak(&total_peak_, total);
+	return true;
+}
+
+void Memory::Release(MemorySubsystem subsystem, int64_t bytes) {
+	current_[subsystem].fetch_sub(bytes, std::memory_order_relaxed);
+	total_.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+void Memory::ResetPeak() {
+	for (int s = 0; s < NUMBER_OF_SUBSYSTEMS; ++s) {
+		peak_[s].store(current_[s].load());
+	}
+	total_peak_.store(total_.load());
+}
+
+const char* Memory::Name(MemorySubsystem subsystem) {
+	switch (subsystem) {
+	case MATRIX:
+		return "matrix";
+	case VECTOR:
+		return "vector";
+	case DP_WORKSPACE:
+		return "dp_workspace";
+	case TRACER:
+		return "tracer";
+	default:
+		return "unknown";
+	}
+}
+
+std::string Memory::ToJson() {
+	std::string output = "{\n";
+	for (int s = 0; s < NUMBER_OF_SUBSYSTEMS; ++s) {
+		MemorySubsystem subsystem = static_cast<MemorySubsystem>(s);
+		output += "  \"" + std::string(Name(subsystem))
+				+ "\": {\"current_bytes\": " + std::to_string(current(subsystem))
+				+ ", \"peak_bytes\": " + std::to_string(peak(subsystem))
+				+ "},\n";
+	}
+	output += "  \"total\": {\"current_bytes\": " + std::to_string(current())
+			+ ", \"peak_bytes\": " + std::to_string(peak()) + "}\n}\n";
+	return output;
+}
+
+} /* namespace n1graph */
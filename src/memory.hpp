@@ -0,0 +1,221 @@
+/*
+ * Copyright 2014 Samuel de Sousa
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef MEMORY_HPP_
+#define MEMORY_HPP_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace n1graph {
+
+/**
+ * The owners of the memory accounted by Memory.
+ */
+enum MemorySubsystem {
+	// Matrix buffers, e.g. the adjacency matrices.
+	MATRIX,
+	// Vector storage, e.g. the node locations.
+	VECTOR,
+	// The state of the sweeps of Minimize, e.g. the Dynamic Programming cube.
+	DP_WORKSPACE,
+	// The per-thread ring buffers of Tracer.
+	TRACER,
+	NUMBER_OF_SUBSYSTEMS
+};
+
+/**
+ * The pages a large buffer is placed on.
+ */
+enum PagePolicy {
+	// Whatever the allocator of the process returns.
+	DEFAULT_PAGES,
+	// Pages the kernel is advised to back with transparent huge pages.
+	TRANSPARENT_HUGE_PAGES,
+	// Pages of the reserved huge page pool, or transparent huge pages if the
+	// pool cannot hold the buffer.
+	EXPLICIT_HUGE_PAGES
+};
+
+/**
+ * How the pages of a large buffer are spread over the NUMA nodes.
+ */
+enum NumaPolicy {
+	// The pages land where the allocating thread writes them.
+	LOCAL_NODE,
+	// The rows are written by the threads of the executor of the policy, so
+	// that each page lands on the node of a thread which sweeps it.
+	// Without an executor, the rows are written by the allocating thread.
+	// Spreading a buffer which a single thread sweeps only moves its pages
+	// away from that thread, so N1Graph keeps the cube of the CUBE strategy
+	// on LOCAL_NODE.
+	FIRST_TOUCH,
+	// The pages alternate over the nodes the process may use.
+	INTERLEAVE
+};
+
+class Executor;
+struct AllocationPolicy;
+
+/**
+ * Maps the buffers of a non-default AllocationPolicy straight from the kernel.
+ * On systems other than Linux nothing is mapped and the callers fall back to
+ * the default allocator.
+ */
+class PageAllocator {
+private:
+	PageAllocator() {
+	}
+public:
+	// The size of a huge page on x86-64 and most aarch64 kernels.
+	static const int64_t kHugePageBytes = 2 << 20;
+
+	/**
+	 * Returns whether a buffer of the given size is mapped under the policy.
+	 */
+	static bool Applies(const AllocationPolicy& policy, int64_t bytes);
+
+	/**
+	 * Maps at least bytes of zeroed memory under the policy. Its pages are
+	 * only placed when they are first written.
+	 *
+	 * @param mapped Receives the number of bytes to pass to Unmap.
+	 * @return the buffer, or nullptr if nothing could be mapped.
+	 */
+	static void* Map(const AllocationPolicy& policy, int64_t bytes,
+			int64_t* mapped);
+
+	static void Unmap(void* buffer, int64_t mapped);
+};
+
+/**
+ * How Matrix places its buffers. Buffers smaller than min_bytes_ always use
+ * the default allocator.
+ */
+struct AllocationPolicy {
+	AllocationPolicy() :
+			pages_(PagePolicy::DEFAULT_PAGES), numa_(NumaPolicy::LOCAL_NODE),
+			min_bytes_(PageAllocator::kHugePageBytes), executor_(nullptr) {
+	}
+
+	PagePolicy pages_;
+	NumaPolicy numa_;
+	int64_t min_bytes_;
+	// The threads which write the rows under FIRST_TOUCH, which must outlive
+	// the allocations.
+	Executor* executor_;
+};
+
+/**
+ * Process-wide accounting of the memory allocated by the library, with the
+ * current and the peak number of bytes per subsystem. It is disabled by
+ * default. Only the allocations made while it is enabled are accounted, so
+ * that enabling it at any time keeps the figures consistent.
+ */
+class Memory {
+private:
+	Memory() {
+	}
+public:
+	static void Enable(bool enabled) {
+		enabled_.store(enabled, std::memory_order_relaxed);
+	}
+
+	static bool enabled() {
+		return enabled_.load(std::memory_order_relaxed);
+	}
+
+	/**
+	 * Accounts an allocation.
+	 *
+	 * @return whether it was accounted, i.e. whether the matching Release
+	 * must be called.
+	 */
+	static bool Allocate(MemorySubsystem subsystem, int64_t bytes);
+
+	/**
+	 * Accounts the release of an allocation previously accounted.
+	 */
+	static void Release(MemorySubsystem subsystem, int64_t bytes);
+
+	static int64_t current(MemorySubsystem subsystem) {
+		return current_[subsystem].load(std::memory_order_relaxed);
+	}
+
+	static int64_t peak(MemorySubsystem subsystem) {
+		return peak_[subsystem].load(std::memory_order_relaxed);
+	}
+
+	/**
+	 * The bytes currently allocated by all the subsystems.
+	 */
+	static int64_t current() {
+		return total_.load(std::memory_order_relaxed);
+	}
+
+	/**
+	 * The highest value reached by current().
+	 */
+	static int64_t peak() {
+		return total_peak_.load(std::memory_order_relaxed);
+	}
+
+	/**
+	 * Sets the peaks to the current values, e.g. before a run.
+	 */
+	static void ResetPeak();
+
+	/**
+	 * Returns the current and peak bytes of each subsystem as JSON.
+	 */
+	static std::string ToJson();
+
+	static const char* Name(MemorySubsystem subsystem);
+
+private:
+	static std::atomic<bool> enabled_;
+	static std::atomic<int64_t> current_[NUMBER_OF_SUBSYSTEMS];
+	static std::atomic<int64_t> peak_[NUMBER_OF_SUBSYSTEMS];
+	static std::atomic<int64_t> total_;
+	static std::atomic<int64_t> total_peak_;
+};
+
+/**
+ * Accounts a workspace which is not held by a Matrix or a Vector during its
+ * scope.
+ */
+class ScopedAllocation {
+public:
+	ScopedAllocation(MemorySubsystem subsystem, int64_t bytes) :
+			subsystem_(subsystem), bytes_(bytes), accounted_(
+					Memory::Allocate(subsystem, bytes)) {
+	}
+
+	~ScopedAllocation() {
+		if (accounted_)
+			Memory::Release(subsystem_, bytes_);
+	}
+
+private:
+	MemorySubsystem subsystem_;
+	int64_t bytes_;
+	bool accounted_;
+};
+
+} /* namespace n1graph */
+#endif /* MEMORY_HPP_ */
@@ -0,0 +1,209 @@
+/*
+ * Copyright 2014 Samuel de Sousa
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+
+#include "gtest/gtest.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+#include <executor.hpp>
+#include <generator.hpp>
+#include <matrix.hpp>
+#include <memory.hpp>
+#include <n1graph.hpp>
+
+using namespace n1graph;
+
+TEST(MemoryTest, PeakOfMinimizeMatchesTheEstimate) {
+	Memory::Enable(true);
+	const int n = 80;
+	// The workspace of the cube, i.e. the difference of the estimates.
+	int64_t cube_bytes = N1Graph::EstimateMemory(n, SolverStrategy::CUBE,
+			false) - N1Graph::EstimateMemory(n, SolverStrategy::ROLLING, false);
+	for (SolverStrategy strategy : { SolverStrategy::CUBE,
+			SolverStrategy::ROLLING }) {
+		int64_t start = Memory::current();
+		int64_t estimate = N1Graph::EstimateMemory(n, strategy, false);
+		{
+			AdjacencyGraph input = Generator::EuclideanGraph(
+					Generator::Uniform(n, 100.f, 400));
+			Memory::ResetPeak();
+			EXPECT_EQ(Memory::peak(), Memory::current());
+			EXPECT_EQ(Memory::peak(MemorySubsystem::DP_WORKSPACE),
+					Memory::current(MemorySubsystem::DP_WORKSPACE));
+			N1Graph graph;
+			graph.set_strategy(strategy);
+			graph.Minimize(input);
+			// The estimate is within 5% of the peak, graphs included.
+			EXPECT_NEAR(Memory::peak() - start, estimate, 0.05 * estimate);
+			int64_t workspace = Memory::peak(MemorySubsystem::DP_WORKSPACE);
+			if (strategy == SolverStrategy::CUBE)
+				EXPECT_NEAR(workspace, cube_bytes, 0.05 * cube_bytes);
+			else
+				EXPECT_LE(workspace, n * sizeof(int64_t));
+			EXPECT_EQ(Memory::current(MemorySubsystem::DP_WORKSPACE), 0);
+		}
+		// The input and the result are released with their owners.
+		EXPECT_EQ(Memory::current(), start);
+		EXPECT_GT(Memory::peak(), Memory::current());
+		Memory::ResetPeak();
+		EXPECT_EQ(Memory::peak(), start);
+	}
+	Memory::Enable(false);
+}
+
+namespace {
+
+// The dimensions of a channel of floats which spans a huge page, i.e. the
+// min_bytes_ of the default policy.
+const int kCols = 1024;
+const int kRows = 512;
+
+// Returns whether every cell of the channels of the matrix holds value.
+bool Holds(const Matrix<float>& matrix, float value) {
+	for (int c = 0; c < matrix.channels(); ++c) {
+		for (int row = 0; row < matrix.rows(); ++row) {
+			for (int col = 0; col < matrix.cols(); ++col) {
+				if (matrix(row, col, c) != value)
+					return false;
+			}
+		}
+	}
+	return true;
+}
+
+// Writes a distinct value to each cell and returns whether they read back.
+bool Writable(Matrix<float>* matrix) {
+	for (int c = 0; c < matrix->channels(); ++c) {
+		for (int row = 0; row < matrix->rows(); ++row) {
+			for (int col = 0; col < matrix->cols(); ++col) {
+				(*matrix)(row, col, c) = c + row * kCols + col;
+			}
+		}
+	}
+	for (int c = 0; c < matrix->channels(); ++c) {
+		for (int row = 0; row < matrix->rows(); ++row) {
+			for (int col = 0; col < matrix->cols(); ++col) {
+				if ((*matrix)(row, col, c) != c + row * kCols + col)
+					return false;
+			}
+		}
+	}
+	return true;
+}
+
+}  // namespace
+
+TEST(MemoryTest, PoliciesPlaceZeroedWritableMatrices) {
+	Memory::Enable(true);
+	ThreadPool pool(4);
+	std::vector<AllocationPolicy> policies;
+	for (PagePolicy pages : { PagePolicy::DEFAULT_PAGES,
+			PagePolicy::TRANSPARENT_HUGE_PAGES, PagePolicy::EXPLICIT_HUGE_PAGES }) {
+		for (NumaPolicy numa : { NumaPolicy::LOCAL_NODE, NumaPolicy::FIRST_TOUCH,
+				NumaPolicy::INTERLEAVE }) {
+			AllocationPolicy policy;
+			policy.pages_ = pages;
+			policy.numa_ = numa;
+			policies.push_back(policy);
+			if (numa == NumaPolicy::FIRST_TOUCH) {
+				policy.executor_ = &pool;
+				policies.push_back(policy);
+			}
+		}
+	}
+	for (const AllocationPolicy& policy : policies) {
+		SCOPED_TRACE(
+				"pages " + std::to_string(policy.pages_) + ", numa "
+						+ std::to_string(policy.numa_) + ", executor "
+						+ std::to_string(policy.executor_ != nullptr));
+		int64_t start = Memory::current(MemorySubsystem::MATRIX);
+		{
+			Matrix<float> matrix;
+			matrix.set_allocation_policy(policy);
+			matrix.Allocate(kCols, kRows, 2, 0);
+			EXPECT_EQ(
+					PageAllocator::Applies(policy,
+							matrix.bytes() / matrix.channels()),
+					policy.pages_ != PagePolicy::DEFAULT_PAGES
+							|| policy.numa_ != NumaPolicy::LOCAL_NODE);
+			EXPECT_EQ(Memory::current(MemorySubsystem::MATRIX) - start,
+					matrix.bytes());
+			EXPECT_TRUE(Holds(matrix, 0));
+			EXPECT_TRUE(Writable(&matrix));
+			// The rows of the default value are written under the policy too.
+			matrix.Allocate(kCols, kRows, 1, 7);
+			EXPECT_EQ(Memory::current(MemorySubsystem::MATRIX) - start,
+					matrix.bytes());
+			EXPECT_TRUE(Holds(matrix, 7));
+			// Moving the buffer to the default pages and back keeps the cells.
+			EXPECT_TRUE(Writable(&matrix));
+			matrix.set_allocation_policy(AllocationPolicy());
+			matrix.set_allocation_policy(policy);
+			Matrix<float> copy(matrix);
+			for (const Matrix<float>* moved : { &matrix, &copy }) {
+				for (int row = 0; row < kRows; row += 97) {
+					EXPECT_EQ((*moved)(row, row), row * kCols + row);
+				}
+			}
+			EXPECT_EQ(Memory::current(MemorySubsystem::MATRIX) - start,
+					matrix.bytes() + copy.bytes());
+		}
+		EXPECT_EQ(Memory::current(MemorySubsystem::MATRIX), start);
+	}
+	Memory::Enable(false);
+}
+
+#ifdef __linux__
+TEST(MemoryTest, FailedMappingsFallBackToTheDefaultAllocator) {
+	// The address space is capped in a child process, just above the buffer
+	// but below the huge page of slack the aligned mapping asks for. The child
+	// is re-executed, as the threads of the earlier tests may hold locks.
+	::testing::FLAGS_gtest_death_test_style = "threadsafe";
+	EXPECT_EXIT({
+		int64_t pages = 0;
+		std::ifstream("/proc/self/statm") >> pages;
+		const int64_t bytes = static_cast<int64_t>(kCols) * kRows * sizeof(float);
+		rlimit limit;
+		getrlimit(RLIMIT_AS, &limit);
+		limit.rlim_cur = pages * sysconf(_SC_PAGESIZE) + bytes
+				+ PageAllocator::kHugePageBytes / 2;
+		setrlimit(RLIMIT_AS, &limit);
+		AllocationPolicy policy;
+		policy.pages_ = PagePolicy::TRANSPARENT_HUGE_PAGES;
+		policy.numa_ = NumaPolicy::INTERLEAVE;
+		int64_t mapped = -1;
+		bool failed = PageAllocator::Map(policy, bytes, &mapped) == nullptr
+				&& mapped == 0;
+		Memory::Enable(true);
+		Matrix<float> matrix;
+		matrix.set_allocation_policy(policy);
+		matrix.Allocate(kCols, kRows, 1, 3);
+		bool fallback = matrix.bytes() == bytes
+				&& Memory::current(MemorySubsystem::MATRIX) == bytes
+				&& Holds(matrix, 3) && Writable(&matrix);
+		std::exit(failed && fallback ? 0 : 1);
+	}, ::testing::ExitedWithCode(0), "");
+}
+#endif
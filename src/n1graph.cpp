@@ -17,14 +17,222 @@
 #include <n1graph.hpp>
 
 #include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <random>
+#include <sstream>
 #include <tuple>
 #include <vector>
 
 #include <adjacency_graph.hpp>
+#include <checkpoint.hpp>
+#include <executor.hpp>
+#include <local_search.hpp>
+#include <memory.hpp>
+#include <node_set.hpp>
+#include <partition.hpp>
+#include <small_solver.hpp>
+#include <stats.hpp>
+#include <tracer.hpp>
 
 namespace n1graph {
 
-N1Graph::N1Graph() {
+namespace {
+
+// The time to read one distance in a sweep, measured on a release build.
+const double kSecondsPerDistance = 3e-9;
+
+// The serial runs shorter than this are not worth spreading over threads.
+const double kParallelSeconds = 0.01;
+
+// The number of nodes reordered around each boundary between two leaves of
+// MinimizeHierarchical.
+const int kRepairWindow = 16;
+
+// The largest point-sets minimized by SmallSolver.
+const int kSmallSolverNodes = 64;
+
+// Runs the smallest instantiation of SmallSolver which fits distances.
+float MinimizeSmall(const Matrix<float>& distances, std::vector<int>* nodes) {
+	int n = distances.rows();
+	if (n <= 8)
+		return SmallSolver<8>::Minimize(distances, nodes);
+	if (n <= 16)
+		return SmallSolver<16>::Minimize(distances, nodes);
+	if (n <= 32)
+		return SmallSolver<32>::Minimize(distances, nodes);
+	return SmallSolver<kSmallSolverNodes>::Minimize(distances, nodes);
+}
+
+const char* StrategyName(SolverStrategy strategy) {
+	switch (strategy) {
+	case SolverStrategy::CUBE:
+		return "CUBE";
+	case SolverStrategy::ROLLING:
+		return "ROLLING";
+	default:
+		return "AUTO";
+	}
+}
+
+}  // namespace
+
+/**
+ * The state of a run of Minimize shared by its sweeps: the progress reported
+ * to the callback and the cancellation.
+ */
+class SweepMonitor {
+public:
+	SweepMonitor(int total, const ProgressCallback& callback, int interval,
+			const CancellationToken& cancellation) :
+			callback_(callback), interval_(std::max(1, interval)), cancellation_(
+					cancellation), checkpoint_(nullptr), checkpoint_interval_(1), sweeps_(
+					nullptr), sweep_costs_(nullptr) {
+		progress_.completed_ = 0;
+		progress_.total_ = total;
+		progress_.best_cost_ = std::numeric_limits<float>::max();
+		lowest_[0] = lowest_[1] = std::numeric_limits<float>::max();
+	}
+
+	/**
+	 * The lowest and the second lowest cost of the complete sweeps of this
+	 * run.
+	 */
+	float lowest(int rank) const {
+		return lowest_[rank];
+	}
+
+	bool cancelled() const {
+		return cancellation_.cancelled();
+	}
+
+	/**
+	 * Whether every initial node has been swept.
+	 */
+	bool finished() {
+		std::lock_guard<std::mutex> lock(mutex_);
+		return progress_.completed_ == progress_.total_;
+	}
+
+	/**
+	 * Keeps the state of the run in checkpoint, which may hold the state of a
+	 * previous run, and writes it every interval initial nodes. The sweeps
+	 * are those kept by an incremental run, empty otherwise.
+	 */
+	void set_checkpoint(Checkpoint* checkpoint, const std::string& location,
+			int interval, const std::vector<std::vector<int> >& sweeps,
+			const std::vector<float>& sweep_costs) {
+		checkpoint_ = checkpoint;
+		location_ = location;
+		checkpoint_interval_ = std::max(1, interval);
+		sweeps_ = &sweeps;
+		sweep_costs_ = &sweep_costs;
+		for (char completed : checkpoint->completed_) {
+			progress_.completed_ += completed;
+		}
+		// The gap of a sampled run also covers the sweeps of the previous
+		// run.
+		if (!checkpoint->best_nodes_.empty()) {
+			progress_.best_cost_ = checkpoint->best_cost_;
+			lowest_[0] = checkpoint->best_cost_;
+			lowest_[1] = checkpoint->second_cost_;
+		}
+	}
+
+	/**
+	 * Records the sweep of an initial node. nodes is nullptr if the sweep was
+	 * pruned.
+	 */
+	void Completed(int initial_node, const std::vector<int>* nodes,
+			float cost) {
+		std::lock_guard<std::mutex> lock(mutex_);
+		++progress_.completed_;
+		if (nodes != nullptr) {
+			progress_.best_cost_ = std::min(progress_.best_cost_, cost);
+			if (cost < lowest_[0]) {
+				lowest_[1] = lowest_[0];
+				lowest_[0] = cost;
+			} else if (cost < lowest_[1]) {
+				lowest_[1] = cost;
+			}
+		}
+		if (callback_
+				&& (progress_.completed_ % interval_ == 0
+						|| progress_.completed_ == progress_.total_))
+			callback_(progress_);
+		if (checkpoint_ == nullptr)
+			return;
+		checkpoint_->completed_[initial_node] = 1;
+		checkpoint_->second_cost_ = lowest_[1];
+		// The ties are resolved in favour of the lowest initial node, like in
+		// a single run.
+		std::vector<int>& best = checkpoint_->best_nodes_;
+		if (nodes != nullptr
+				&& (best.empty() || cost < checkpoint_->best_cost_
+						|| (cost == checkpoint_->best_cost_
+								&& initial_node < best[0]))) {
+			checkpoint_->best_cost_ = cost;
+			best = *nodes;
+		}
+		if (progress_.completed_ % checkpoint_interval_ == 0
+				&& progress_.completed_ < progress_.total_)
+			WriteCheckpoint();
+	}
+
+	/**
+	 * Writes the checkpoint, e.g. once the run is cancelled.
+	 */
+	void WriteCheckpoint() {
+		// Only the sweeps of the completed initial nodes are final.
+		if (!sweeps_->empty()) {
+			size_t n = checkpoint_->completed_.size();
+			checkpoint_->sweeps_.resize(n);
+			checkpoint_->sweep_costs_.resize(n);
+			for (size_t i = 0; i < n; ++i) {
+				if (checkpoint_->completed_[i]) {
+					checkpoint_->sweeps_[i] = (*sweeps_)[i];
+					checkpoint_->sweep_costs_[i] = (*sweep_costs_)[i];
+				}
+			}
+		}
+		checkpoint_->Write(location_);
+	}
+
+private:
+	const ProgressCallback& callback_;
+	int interval_;
+	CancellationToken cancellation_;
+	std::mutex mutex_;
+	MinimizeProgress progress_;
+	float lowest_[2];
+	Checkpoint* checkpoint_;
+	std::string location_;
+	int checkpoint_interval_;
+	const std::vector<std::vector<int> >* sweeps_;
+	const std::vector<float>* sweep_costs_;
+};
+
+std::string SolverPlan::ToString() const {
+	std::ostringstream output;
+	output << "strategy: " << StrategyName(strategy_) << "\n" << "threads: "
+			<< threads_ << "\n" << "estimated bytes: " << estimated_bytes_
+			<< "\n" << "estimated seconds: " << estimated_seconds_ << "\n"
+			<< "fits the budget: " << (fits_ ? "yes" : "no") << "\n"
+			<< "reasons:\n" << explanation_;
+	return output.str();
+}
+
+N1Graph::N1Graph() :
+		cost_(0), strategy_(SolverStrategy::ROLLING), executor_(nullptr), progress_interval_(
+				1), monitor_(nullptr), cancelled_(false), checkpoint_interval_(1), candidates_(0), precision_(
+				CostPrecision::SINGLE_PRECISION), precise_cost_(0), small_solver_(
+				true), sampling_(
+				StartSampling::EVERY_START), sampling_count_(0), sampling_seed_(
+				0), sampling_estimate_( { 0, 0, 0, 0 }), incremental_(false) {
 
 }
 
@@ -42,14 +250,38 @@ float JoinIsolate(const AdjacencyGraph& input, int reference_node,
 }
 
 float JoinGraph(const AdjacencyGraph& input, int latest_node,
-		int const * used_nodes) {
+		const NodeSet& used_nodes) {
+	// The used nodes are visited in increasing order, which fixes the order
+	// of the accumulation.
+	const float* row = &input.adjacency()(latest_node, 0);
 	float cost = 0;
-	for (int i = 0; i < input.NumberOfNodes(); ++i) {
-		if (used_nodes[i] == 1) {
-			cost += input.adjacency()(latest_node, i);
+	used_nodes.ForEach([row, &cost](int i) {
+		cost += row[i];
+	});
+	return cost;
+}
+
+double EvaluateUnits(const AdjacencyGraph& input,
+		const std::vector<int>& nodes) {
+	// The units are summed exactly, like in the sweeps of Minimize.
+	const Matrix<uint16_t>& units = input.quantized_adjacency();
+	int n = input.NumberOfNodes();
+	NodeSet used_nodes(n);
+	used_nodes.Insert(nodes[0]);
+	int64_t cost = 0;
+	for (int k = 1; k < n; ++k) {
+		CHECK(!used_nodes.Contains(nodes[k]));
+		if (k % 2 == 0) {
+			const uint16_t* row = &units(nodes[k], 0);
+			used_nodes.ForEach([row, &cost](int i) {
+				cost += row[i];
+			});
+		} else {
+			cost += units(nodes[k], nodes[k - 1]);
 		}
+		used_nodes.Insert(nodes[k]);
 	}
-	return cost;
+	return cost * static_cast<double>(input.quantization_scale());
 }
 
 std::vector<int> N1Graph::TraceBack(const Matrix<float>& dp, int layer) {
@@ -81,22 +313,27 @@ std::vector<int> N1Graph::TraceBack(const Matrix<float>& dp, int layer) {
 	// Finally we add the first node which is the same as the level.
 	nodes.push_back(location[2]);
 	std::reverse(nodes.begin(), nodes.end());
-	std::string nodes_str = "";
-	for (int node : nodes) {
-		nodes_str += std::to_string(node);
-		nodes_str += ",";
+	if (VLOG_IS_ON(2)) {
+		std::string nodes_str = "";
+		for (int node : nodes) {
+			nodes_str += std::to_string(node);
+			nodes_str += ",";
+		}
+		VLOG(2) << "[BackTrace] " << nodes_str;
 	}
-	LOG(INFO)<< "[BackTrace] " <<nodes_str;
 	return nodes;
 }
 
 void N1Graph::BuildGraph(const std::vector<int>& nodes) {
+	ScopedTimer timer(StatsPhase::BUILD_GRAPH);
+	ScopedTrace trace(StatsPhase::BUILD_GRAPH);
 	CHECK_GT(nodes.size(), 2);
+	nodes_ = nodes;
 	result_.AddEdge(nodes[0], nodes[1]);
 
 	bool join_graph = true;
-	int max_iterations = nodes.size() / 2 * 2;
-	for (int i = 2; i < (nodes.size()/2)*2; ++i) {
+	int max_iterations = static_cast<int>(nodes.size()) / 2 * 2;
+	for (int i = 2; i < max_iterations; ++i) {
 		if (join_graph) {
 			// Join.
 			for (int j = 0; j < i; ++j) {
@@ -124,34 +361,626 @@ int N1Graph::FindOptimalLayer(const Matrix<float>& dp) {
 	return location[2] + 1;
 }
 
-void N1Graph::Minimize(const AdjacencyGraph& input) {
-	size_t n = input.NumberOfNodes();
-	result_.Initialize(n, GraphType::UNDIRECTED, 0);
-	for (int i = 0; i < input.NumberOfNodes(); ++i) {
+float N1Graph::Evaluate(const AdjacencyGraph& input,
+		const std::vector<int>& nodes) {
+	int n = input.NumberOfNodes();
+	CHECK_EQ(static_cast<int>(nodes.size()), n);
+	if (input.quantized())
+		return EvaluateUnits(input, nodes);
+	NodeSet used_nodes(n);
+	used_nodes.Insert(nodes[0]);
+	// The same accumulation as Minimize, so that both costs are comparable.
+	float cost = 0;
+	bool join_graph = false;
+	for (int k = 1; k < n; ++k) {
+		CHECK(!used_nodes.Contains(nodes[k]));
+		if (join_graph)
+			cost += JoinGraph(input, nodes[k], used_nodes);
+		else
+			cost += JoinIsolate(input, nodes[k], nodes[k - 1]);
+		used_nodes.Insert(nodes[k]);
+		join_graph = !join_graph;
+	}
+	return cost;
+}
+
+double N1Graph::EvaluatePrecise(const AdjacencyGraph& input,
+		const std::vector<int>& nodes) {
+	int n = input.NumberOfNodes();
+	CHECK_EQ(static_cast<int>(nodes.size()), n);
+	if (input.quantized())
+		return EvaluateUnits(input, nodes);
+	const Matrix<float>& distances = input.adjacency();
+	NodeSet used_nodes(n);
+	used_nodes.Insert(nodes[0]);
+	double cost = 0;
+	for (int k = 1; k < n; ++k) {
+		CHECK(!used_nodes.Contains(nodes[k]));
+		if (k % 2 == 0) {
+			const float* row = &distances(nodes[k], 0);
+			used_nodes.ForEach([row, &cost](int i) {
+				cost += row[i];
+			});
+		} else {
+			cost += distances(nodes[k], nodes[k - 1]);
+		}
+		used_nodes.Insert(nodes[k]);
+	}
+	return cost;
+}
+
+std::vector<float> N1Graph::Evaluate(const AdjacencyGraph& input,
+		const std::vector<std::vector<int> >& orders, Executor* executor) {
+	if (executor == nullptr)
+		executor = Executor::Default();
+	std::vector<float> costs(orders.size());
+	executor->ParallelFor(0, orders.size(), [&input, &orders, &costs](int k) {
+		costs[k] = Evaluate(input, orders[k]);
+	});
+	return costs;
+}
+
+float N1Graph::Complete(const AdjacencyGraph& input,
+		std::vector<int>* nodes, float bound, const SweepMonitor* monitor) {
+	return CompleteIn<float>(input.adjacency(), nodes, bound, monitor);
+}
+
+template<typename Cost, typename Weight>
+Cost N1Graph::CompleteIn(const Matrix<Weight>& weights,
+		std::vector<int>* nodes, Cost bound, const SweepMonitor* monitor) {
+	int n = weights.rows();
+	CHECK_GT(nodes->size(), 0);
+	CHECK_LE(nodes->size(), n);
+	ScopedAllocation workspace(MemorySubsystem::DP_WORKSPACE,
+			(n + 63) / 64 * sizeof(uint64_t));
+	NodeSet used_nodes(n);
+	used_nodes.Insert((*nodes)[0]);
+	// The same accumulation as JoinGraph and JoinIsolate.
+	auto join = [&weights, &used_nodes](int node) {
+		const Weight* row = &weights(node, 0);
+		Cost cost = 0;
+		used_nodes.ForEach([row, &cost](int i) {
+			cost += row[i];
+		});
+		return cost;
+	};
+	Cost cost = 0;
+	bool join_graph = false;
+	for (int k = 1; k < static_cast<int>(nodes->size()); ++k) {
+		if (join_graph)
+			cost += join((*nodes)[k]);
+		else
+			cost += weights((*nodes)[k], (*nodes)[k - 1]);
+		used_nodes.Insert((*nodes)[k]);
+		join_graph = !join_graph;
+	}
+	// The first node with the strictly lowest cost is selected, like in the
+	// sweep of Minimize.
+	for (int k = nodes->size(); k < n; ++k) {
+		if (cost >= bound) {
+			Stats::Increment(StatsCounter::SWEEPS_PRUNED);
+			break;
+		}
+		if (monitor != nullptr && monitor->cancelled())
+			break;
+		ScopedTimer layer_timer(StatsPhase::MINIMIZE_LAYER);
+		Stats::Increment(StatsCounter::CANDIDATES_EVALUATED, n - k);
+		int latest_node = nodes->back();
+		int candidate = -1;
+		Cost candidate_cost = 0;
+		used_nodes.ForEachMissing([&](int j) {
+			Cost new_cost = cost;
+			if (join_graph)
+				new_cost += join(j);
+			else
+				new_cost += weights(j, latest_node);
+			if (candidate < 0 || new_cost < candidate_cost) {
+				candidate = j;
+				candidate_cost = new_cost;
+			}
+		});
+		cost = candidate_cost;
+		nodes->push_back(candidate);
+		used_nodes.Insert(candidate);
+		join_graph = !join_graph;
+	}
+	return cost;
+}
+
+float N1Graph::CompleteNearest(const AdjacencyGraph& input,
+		const std::vector<int>& neighbours, int k, std::vector<int>* nodes,
+		float bound, const SweepMonitor* monitor) {
+	int n = input.NumberOfNodes();
+	CHECK_GT(nodes->size(), 0);
+	CHECK_LE(nodes->size(), n);
+	CHECK_EQ(neighbours.size(), static_cast<size_t>(n) * k);
+	ScopedAllocation workspace(MemorySubsystem::DP_WORKSPACE,
+			(n + 63) / 64 * sizeof(uint64_t));
+	NodeSet used_nodes(n);
+	used_nodes.Insert((*nodes)[0]);
+	const Matrix<float>& adjacency = input.adjacency();
+	// A join costs the distances to the first nodes of the sequence, which
+	// are cheaper to walk than the flags of all the nodes.
+	auto join_cost = [&](int j, int length) {
+		float cost = 0;
+		for (int s = 0; s < length; ++s) {
+			cost += adjacency(j, (*nodes)[s]);
+		}
+		return cost;
+	};
+	float cost = 0;
+	bool join_graph = false;
+	for (int s = 1; s < static_cast<int>(nodes->size()); ++s) {
+		int node = (*nodes)[s];
+		cost += join_graph ?
+				join_cost(node, s) : adjacency(node, (*nodes)[s - 1]);
+		used_nodes.Insert(node);
+		join_graph = !join_graph;
+	}
+	for (int s = nodes->size(); s < n; ++s) {
+		if (cost >= bound) {
+			Stats::Increment(StatsCounter::SWEEPS_PRUNED);
+			break;
+		}
+		if (monitor != nullptr && monitor->cancelled())
+			break;
+		ScopedTimer layer_timer(StatsPhase::MINIMIZE_LAYER);
+		int latest_node = nodes->back();
+		int candidate = -1;
+		float candidate_cost = 0;
+		int evaluated = 0;
+		auto evaluate = [&](int j) {
+			float new_cost = cost
+					+ (join_graph ?
+							join_cost(j, nodes->size()) :
+							adjacency(j, latest_node));
+			++evaluated;
+			if (candidate < 0 || new_cost < candidate_cost
+					|| (new_cost == candidate_cost && j < candidate)) {
+				candidate = j;
+				candidate_cost = new_cost;
+			}
+		};
+		const int* row = &neighbours[static_cast<size_t>(latest_node) * k];
+		for (int c = 0; c < k; ++c) {
+			if (!used_nodes.Contains(row[c]))
+				evaluate(row[c]);
+		}
+		// The neighbours are exhausted, thus we fall back to a full scan.
+		if (candidate < 0)
+			used_nodes.ForEachMissing(evaluate);
+		Stats::Increment(StatsCounter::CANDIDATES_EVALUATED, evaluated);
+		cost = candidate_cost;
+		nodes->push_back(candidate);
+		used_nodes.Insert(candidate);
+		join_graph = !join_graph;
+	}
+	return cost;
+}
+
+std::vector<int> N1Graph::NearestNeighbours(const AdjacencyGraph& input,
+		int k) {
+	int n = input.NumberOfNodes();
+	CHECK_GT(k, 0);
+	k = std::min(k, n - 1);
+	std::vector<int> neighbours(static_cast<size_t>(n) * k);
+	std::vector<int> order(n);
+	for (int i = 0; i < n; ++i) {
+		order.clear();
+		for (int j = 0; j < n; ++j) {
+			if (j != i)
+				order.push_back(j);
+		}
+		const Matrix<float>& adjacency = input.adjacency();
+		std::partial_sort(order.begin(), order.begin() + k, order.end(),
+				[&](int first, int second) {
+					float d1 = adjacency(i, first), d2 = adjacency(i, second);
+					return d1 < d2 || (d1 == d2 && first < second);
+				});
+		std::copy(order.begin(), order.begin() + k,
+				neighbours.begin() + static_cast<size_t>(i) * k);
+	}
+	return neighbours;
+}
+
+void N1Graph::BuildBestSweep() {
+	int best = -1;
+	for (int i = 0; i < static_cast<int>(sweeps_.size()); ++i) {
+		if (sweeps_[i].empty())
+			continue;
+		if (best < 0 || sweep_costs_[i] < sweep_costs_[best])
+			best = i;
+	}
+	CHECK_GE(best, 0);
+	cost_ = sweep_costs_[best];
+	precise_cost_ = cost_;
+	BuildGraph(sweeps_[best]);
+}
+
+bool N1Graph::Insert(AdjacencyGraph* input, const Vector<float>& location) {
+	CHECK_EQ(nodes_.size(), input->NumberOfNodes());
+	int inserted = input->AddEuclideanNode(location);
+	int n = input->NumberOfNodes();
+	Reset(*input);
+	bool exact = static_cast<int>(sweeps_.size()) == n - 1;
+	std::vector<std::vector<int>*> affected;
+	if (exact) {
+		for (std::vector<int>& sweep : sweeps_) {
+			if (!sweep.empty())
+				affected.push_back(&sweep);
+		}
+	} else {
+		affected.push_back(&nodes_);
+	}
+	NodeSet used_nodes(n);
+	for (std::vector<int>* sweep : affected) {
+		// Finds the first step where the new node would have been selected.
+		// Since it has the highest index, it only wins strictly lower costs.
+		used_nodes.Clear();
+		used_nodes.Insert((*sweep)[0]);
+		float cost = 0;
+		bool join_graph = false;
+		int k = 1;
+		for (; k < static_cast<int>(sweep->size()); ++k) {
+			int node = (*sweep)[k];
+			float node_cost = cost;
+			float inserted_cost = cost;
+			if (join_graph) {
+				node_cost += JoinGraph(*input, node, used_nodes);
+				inserted_cost += JoinGraph(*input, inserted, used_nodes);
+			} else {
+				node_cost += JoinIsolate(*input, node, (*sweep)[k - 1]);
+				inserted_cost += JoinIsolate(*input, inserted,
+						(*sweep)[k - 1]);
+			}
+			if (inserted_cost < node_cost)
+				break;
+			cost = node_cost;
+			used_nodes.Insert(node);
+			join_graph = !join_graph;
+		}
+		sweep->resize(k);
+	}
+	if (exact) {
+		for (int i = 0; i < n - 1; ++i) {
+			if (!sweeps_[i].empty())
+				sweep_costs_[i] = Complete(*input, &sweeps_[i]);
+		}
+		sweeps_.push_back(std::vector<int>(1, inserted));
+		sweep_costs_.push_back(Complete(*input, &sweeps_.back()));
+		BuildBestSweep();
+	} else {
+		std::vector<int> nodes = nodes_;
+		cost_ = Complete(*input, &nodes);
+		precise_cost_ = cost_;
+		BuildGraph(nodes);
+	}
+	return exact;
+}
+
+bool N1Graph::Remove(AdjacencyGraph* input, int node) {
+	CHECK_EQ(nodes_.size(), input->NumberOfNodes());
+	CHECK_GT(input->NumberOfNodes(), 3);
+	int n = input->NumberOfNodes() - 1;
+	input->RemoveNode(node);
+	Reset(*input);
+	bool exact = static_cast<int>(sweeps_.size()) == n + 1;
+	std::vector<std::vector<int>*> affected;
+	if (exact) {
+		sweeps_.erase(sweeps_.begin() + node);
+		sweep_costs_.erase(sweep_costs_.begin() + node);
+		for (std::vector<int>& sweep : sweeps_) {
+			if (!sweep.empty())
+				affected.push_back(&sweep);
+		}
+	} else {
+		affected.push_back(&nodes_);
+	}
+	for (std::vector<int>* sweep : affected) {
+		// The sweep is unchanged up to the position of the removed node, the
+		// remaining nodes keep their relative order once renumbered.
+		int position = 0;
+		while ((*sweep)[position] != node)
+			++position;
+		// Without bookkeeping, a removed initial node is replaced by the
+		// second one.
+		if (position == 0) {
+			(*sweep)[0] = (*sweep)[1];
+			position = 1;
+		}
+		sweep->resize(position);
+		for (int& other : *sweep) {
+			if (other > node)
+				--other;
+		}
+	}
+	if (exact) {
+		for (int i = 0; i < n; ++i) {
+			if (!sweeps_[i].empty())
+				sweep_costs_[i] = Complete(*input, &sweeps_[i]);
+		}
+		BuildBestSweep();
+	} else {
+		std::vector<int> nodes = nodes_;
+		cost_ = Complete(*input, &nodes);
+		precise_cost_ = cost_;
+		BuildGraph(nodes);
+	}
+	return exact;
+}
+
+void N1Graph::InitializeResult(const AdjacencyGraph& input) {
+	result_.Initialize(input.NumberOfNodes(), GraphType::UNDIRECTED, 0);
+	for (int i = 0; i < static_cast<int>(input.NumberOfNodes()); ++i) {
 		result_.SetLocation(i, input.location(i));
 	}
+}
+
+void N1Graph::Reset(const AdjacencyGraph& input) {
+	int n = input.NumberOfNodes();
+	InitializeResult(input);
+	plan_ = Explain(n);
+	if (input.quantized()) {
+		plan_.strategy_ = SolverStrategy::ROLLING;
+		plan_.explanation_ += "  distances: quantized to 16 bits, read by "
+				"the rolling sweeps\n";
+	}
+	LOG_IF(WARNING, !plan_.fits_) << "The run exceeds the budget.\n"
+			<< plan_.ToString();
+	VLOG(1) << plan_.ToString();
+}
+
+std::vector<int> N1Graph::SelectStarts(const AdjacencyGraph& input) const {
+	int n = input.NumberOfNodes();
+	int count = std::min(sampling_count_, n);
+	std::vector<int> starts;
+	if (sampling_ == StartSampling::EVERY_START || count <= 0 || count == n) {
+		for (int i = 0; i < n; ++i) {
+			starts.push_back(i);
+		}
+		return starts;
+	}
+	if (sampling_ == StartSampling::RANDOM_STARTS) {
+		// A partial Fisher-Yates shuffle on the raw output of the engine,
+		// whose sequence is fixed by the standard for a given seed.
+		std::mt19937 engine(sampling_seed_);
+		std::vector<int> nodes(n);
+		for (int i = 0; i < n; ++i) {
+			nodes[i] = i;
+		}
+		for (int i = 0; i < count; ++i) {
+			std::swap(nodes[i], nodes[i + engine() % (n - i)]);
+		}
+		starts.assign(nodes.begin(), nodes.begin() + count);
+	} else {
+		std::vector<float> centrality(n);
+		for (int i = 0; i < n; ++i) {
+			centrality[i] = input.adjacency().row_sum(i);
+		}
+		std::vector<int> nodes(n);
+		for (int i = 0; i < n; ++i) {
+			nodes[i] = i;
+		}
+		auto more_central = [&centrality](int first, int second) {
+			return centrality[first] < centrality[second]
+					|| (centrality[first] == centrality[second]
+							&& first < second);
+		};
+		if (sampling_ == StartSampling::CENTRAL_STARTS) {
+			std::partial_sort(nodes.begin(), nodes.begin() + count, nodes.end(),
+					more_central);
+			starts.assign(nodes.begin(), nodes.begin() + count);
+		} else {
+			// Each new start is the node farthest from the selected ones.
+			starts.push_back(
+					*std::min_element(nodes.begin(), nodes.end(),
+							more_central));
+			std::vector<float> distance(n);
+			for (int i = 0; i < n; ++i) {
+				distance[i] = input.adjacency()(i, starts[0]);
+			}
+			while (static_cast<int>(starts.size()) < count) {
+				int farthest = std::max_element(distance.begin(),
+						distance.end()) - distance.begin();
+				starts.push_back(farthest);
+				for (int i = 0; i < n; ++i) {
+					distance[i] = std::min(distance[i],
+							input.adjacency()(i, farthest));
+				}
+			}
+		}
+	}
+	std::sort(starts.begin(), starts.end());
+	return starts;
+}
+
+void N1Graph::SelectCandidates(const AdjacencyGraph& input) {
+	neighbours_.clear();
+	// With every other node as a candidate, the exact sweeps are run.
+	int n = input.NumberOfNodes();
+	if (candidates_ > 0 && candidates_ < n - 1)
+		neighbours_ = NearestNeighbours(input, candidates_);
+}
+
+float N1Graph::Search(const AdjacencyGraph& input,
+		const std::vector<int>& initial_nodes, float bound,
+		std::vector<int>* best_nodes) {
+	// The approximate mode only exists as rolling sweeps.
+	if (plan_.strategy_ == SolverStrategy::ROLLING || !neighbours_.empty())
+		return SearchRolling(input, initial_nodes, bound, best_nodes);
+	return SearchCube(input, initial_nodes, bound, best_nodes);
+}
+
+float N1Graph::SearchRolling(const AdjacencyGraph& input,
+		const std::vector<int>& initial_nodes, float bound,
+		std::vector<int>* best_nodes) {
+	int n = input.NumberOfNodes();
+	return SearchRollingIn<float>(n, initial_nodes, 1, best_nodes,
+			[&](std::vector<int>* nodes) {
+				return neighbours_.empty() ?
+						Complete(input, nodes, bound, monitor_) :
+						CompleteNearest(input, neighbours_,
+								neighbours_.size() / n, nodes, bound,
+								monitor_);
+			});
+}
+
+template<typename Cost, typename Sweep>
+Cost N1Graph::SearchRollingIn(int n, const std::vector<int>& initial_nodes,
+		double unit, std::vector<int>* best_nodes, Sweep sweep) {
+	int chunks = std::max(1,
+			std::min(plan_.threads_, static_cast<int>(initial_nodes.size())));
+	// Each thread sweeps a contiguous chunk of the initial nodes. The best
+	// sweeps of the chunks are merged in order, so that ties are resolved as
+	// in a serial run.
+	std::vector<Cost> chunk_costs(chunks, std::numeric_limits<Cost>::max());
+	std::vector<std::vector<int> > chunk_nodes(chunks);
+	std::function<void(int)> sweep_chunk = [&](int c) {
+		std::vector<int> nodes;
+		for (size_t l = initial_nodes.size() * c / chunks;
+				l < initial_nodes.size() * (c + 1) / chunks; ++l) {
+			int i = initial_nodes[l];
+			ScopedTimer sweep_timer(StatsPhase::MINIMIZE_SWEEP);
+			ScopedTrace sweep_trace(StatsPhase::MINIMIZE_SWEEP, i);
+			nodes.assign(1, i);
+			Cost cost = sweep(&nodes);
+			if (static_cast<int>(nodes.size()) < n) {
+				if (monitor_ == nullptr)
+					continue;
+				if (monitor_->cancelled())
+					break;
+				monitor_->Completed(i, nullptr, 0);
+				continue;
+			}
+			if (!sweeps_.empty()) {
+				sweeps_[i] = nodes;
+				sweep_costs_[i] = cost * unit;
+			}
+			if (monitor_ != nullptr)
+				monitor_->Completed(i, &nodes, cost * unit);
+			if (cost < chunk_costs[c]) {
+				chunk_costs[c] = cost;
+				chunk_nodes[c] = nodes;
+			}
+		}
+	};
+	// A serial run does not touch the executor.
+	if (chunks == 1)
+		sweep_chunk(0);
+	else
+		executor()->ParallelFor(0, chunks, sweep_chunk);
+	Cost best_cost = std::numeric_limits<Cost>::max();
+	for (int c = 0; c < chunks; ++c) {
+		if (chunk_costs[c] < best_cost) {
+			best_cost = chunk_costs[c];
+			best_nodes->swap(chunk_nodes[c]);
+		}
+	}
+	return best_cost;
+}
+
+double N1Graph::SearchPrecise(const AdjacencyGraph& input,
+		const std::vector<int>& initial_nodes,
+		std::vector<int>* best_nodes) {
+	int n = input.NumberOfNodes();
+	if (input.quantized()) {
+		// The units are widened and summed exactly, as in FIXED_POINT.
+		int64_t best_cost = SearchRollingIn<int64_t>(n, initial_nodes,
+				input.quantization_scale(), best_nodes,
+				[&](std::vector<int>* nodes) {
+					return CompleteIn<int64_t>(input.quantized_adjacency(),
+							nodes, std::numeric_limits<int64_t>::max(),
+							monitor_);
+				});
+		return best_nodes->empty() ? std::numeric_limits<double>::max() :
+				best_cost * static_cast<double>(input.quantization_scale());
+	}
+	const Matrix<float>& distances = input.adjacency();
+	if (precision_ == CostPrecision::DOUBLE_PRECISION) {
+		double best_cost = SearchRollingIn<double>(n, initial_nodes, 1,
+				best_nodes, [&](std::vector<int>* nodes) {
+					return CompleteIn<double>(distances, nodes,
+							std::numeric_limits<double>::max(), monitor_);
+				});
+		return best_nodes->empty() ? std::numeric_limits<double>::max() :
+				best_cost;
+	}
+	// Each pair of nodes is summed at most once per sequence, and each
+	// rounded distance errs by at most half a unit, thus the scale keeps the
+	// costs below 2^53, where a double holds every integer.
+	float longest = 0;
+	for (int i = 0; i < n; ++i) {
+		for (int j = 0; j < n; ++j) {
+			longest = std::max(longest, distances(i, j));
+		}
+	}
+	double pairs = static_cast<double>(n) * n;
+	double scale = 1;
+	if (longest > 0)
+		scale = std::ldexp(1., std::ilogb(std::ldexp(1., 52) / pairs / longest));
+	Matrix<int64_t> fixed;
+	fixed.set_subsystem(MemorySubsystem::DP_WORKSPACE);
+	fixed.set_allocation_policy(workspace_policy());
+	fixed.Allocate(n, n, 1, 0);
+	for (int i = 0; i < n; ++i) {
+		for (int j = 0; j < n; ++j) {
+			fixed(i, j) = std::llround(distances(i, j) * scale);
+		}
+	}
+	VLOG(1) << "[Minimize] fixed-point scale " << scale;
+	int64_t best_cost = SearchRollingIn<int64_t>(n, initial_nodes, 1 / scale,
+			best_nodes, [&](std::vector<int>* nodes) {
+				return CompleteIn<int64_t>(fixed, nodes,
+						std::numeric_limits<int64_t>::max(), monitor_);
+			});
+	return best_nodes->empty() ? std::numeric_limits<double>::max() :
+			best_cost / scale;
+}
 
-	Matrix<float> dp(n, n, n, 0);
-	std::unique_ptr<int[]> used_nodes(new int[n]);
+float N1Graph::SearchCube(const AdjacencyGraph& input,
+		const std::vector<int>& initial_nodes, float bound,
+		std::vector<int>* best_nodes) {
+	int n = input.NumberOfNodes();
+	Matrix<float> dp;
+	dp.set_subsystem(MemorySubsystem::DP_WORKSPACE);
+	dp.set_allocation_policy(serial_workspace_policy());
+	dp.Allocate(n, n, initial_nodes.size(), 0);
+	ScopedAllocation workspace(MemorySubsystem::DP_WORKSPACE,
+			(n + 63) / 64 * sizeof(uint64_t));
+	NodeSet used_nodes(n);
 
 	float best_cost = std::numeric_limits<float>::max();
-	std::vector<int> best_nodes;
 
 	// For each initial node being selected.
-	for (int i = 0; i < n; ++i) {
+	for (int l = 0; l < static_cast<int>(initial_nodes.size()); ++l) {
+		ScopedTimer sweep_timer(StatsPhase::MINIMIZE_SWEEP);
+		int i = initial_nodes[l];
+		ScopedTrace sweep_trace(StatsPhase::MINIMIZE_SWEEP, i);
 		std::vector<int> node_list;
-		memset(used_nodes.get(), 0, n * sizeof(int));
-		used_nodes[i] = 1;
+		used_nodes.Clear();
+		used_nodes.Insert(i);
 		// Our algorithm alternates two steps, either join graph or join
 		// isolated node.
 		bool join_graph = false;
 		// Every time a node succeeds to improve the objective function, we
 		// record it.
 		int latest_node = i;
+		// The costs only grow, therefore once a partial solution reaches the
+		// bound it cannot improve over the incumbent.
+		bool pruned = false;
 		// For which number of allowed nodes. In that case, we allow k+1 nodes.
 		// The first iteration means the the optimum with 2 nodes are allowed
 		// (k+1).
 		for (int k = 1; k < n; ++k) {
+			if (dp(k - 1, n - 1, l) >= bound) {
+				Stats::Increment(StatsCounter::SWEEPS_PRUNED);
+				pruned = true;
+				break;
+			}
+			if (monitor_ != nullptr && monitor_->cancelled())
+				return best_cost;
+			ScopedTimer layer_timer(StatsPhase::MINIMIZE_LAYER);
+			Stats::Increment(StatsCounter::CANDIDATES_EVALUATED, n - k);
 			node_list.push_back(i);
 			// We have to accept the first cost found with the new node.
 			bool accept = true;
@@ -160,57 +989,517 @@ void N1Graph::Minimize(const AdjacencyGraph& input) {
 			int candidate_latest = -1;
 			for (int j = 0; j < n; ++j) {
 				// Updating previous cost.
-				//float previous_cost = j > 0 ? dp(k, j - 1, i) : INFINITY;
-				float previous_cost = dp(k, std::max(0, j - 1), i);
+				//float previous_cost = j > 0 ? dp(k, j - 1, l) : INFINITY;
+				float previous_cost = dp(k, std::max(0, j - 1), l);
 				// New cost is at least the best cost found in the previous
 				// iteration.
-				float new_cost = dp(k - 1, n - 1, i);
+				float new_cost = dp(k - 1, n - 1, l);
 				// If the node has been used already, nothing to do here.
-				if (used_nodes[j] == 1) {
-					dp(k, j, i) = previous_cost;
+				if (used_nodes.Contains(j)) {
+					dp(k, j, l) = previous_cost;
 					continue;
 				} else {
 					// Updating new cost.
 					if (join_graph)
-						new_cost += JoinGraph(input, j, used_nodes.get());
+						new_cost += JoinGraph(input, j, used_nodes);
 					else
 						new_cost += JoinIsolate(input, j, latest_node);
 					// If the accept flag is true, it means We don't have any
 					// cost yet with k nodes. We must accept this one and later
 					// optimize over the possible alternatives.
 					if (accept || new_cost < previous_cost) {
-						dp(k, j, i) = new_cost;
+						dp(k, j, l) = new_cost;
 						// In case this is true, it means we have already added
 						// a candidate there.
-						if ( node_list.size() == k + 1)
+						if ( static_cast<int>(node_list.size()) == k + 1)
 							node_list.pop_back();
 						node_list.push_back(j);
 						candidate_latest = j;
 						accept = false;
 					} else {
-						dp(k, j, i) = previous_cost;
+						dp(k, j, l) = previous_cost;
 					}
 				}
 			}
 			CHECK_GE(candidate_latest, 0);
 			latest_node = candidate_latest;
-			used_nodes[latest_node] = 1;
+			used_nodes.Insert(latest_node);
 			join_graph = !join_graph;
 		}
-		if ( dp(n - 1, n - 1, i) < best_cost ) {
-			best_cost = dp(n - 1, n - 1, i);
-			best_nodes = node_list;
+		if (pruned) {
+			if (monitor_ != nullptr)
+				monitor_->Completed(i, nullptr, 0);
+			continue;
+		}
+		if (!sweeps_.empty()) {
+			sweeps_[i] = node_list;
+			sweep_costs_[i] = dp(n - 1, n - 1, l);
+		}
+		if (monitor_ != nullptr)
+			monitor_->Completed(i, &node_list, dp(n - 1, n - 1, l));
+		if ( dp(n - 1, n - 1, l) < best_cost ) {
+			best_cost = dp(n - 1, n - 1, l);
+			*best_nodes = node_list;
 		}
 		node_list.clear();
 		// We push the solution towards the corner of the hypercube. Since the
 		// location (n,n) holds the optimum for that layer, we force the next
 		// layer to be at least as good as the previous one.
-		dp(n - 1, n - 1, i) = std::min(dp(n - 1, n - 1, i),
-				dp(n - 1, n - 1, std::max(0, i - 1)));
+		dp(n - 1, n - 1, l) = std::min(dp(n - 1, n - 1, l),
+				dp(n - 1, n - 1, std::max(0, l - 1)));
+	}
+	return best_cost;
+}
+
+int64_t N1Graph::EstimateMemory(int n, SolverStrategy strategy,
+		bool incremental) {
+	CHECK_NE(strategy, SolverStrategy::AUTO);
+	int64_t v = n;
+	// The adjacency matrices of the input and the result, plus the locations
+	// of the input.
+	int64_t bytes = 2 * v * v * sizeof(float)
+			+ v * (sizeof(Vector<float> ) + 2 * sizeof(float));
+	// The used nodes and the node list of a sweep.
+	bytes += (v + 63) / 64 * sizeof(uint64_t) + v * sizeof(int);
+	if (strategy == SolverStrategy::CUBE)
+		bytes += v * v * v * sizeof(float);
+	if (incremental)
+		bytes += v * v * sizeof(int) + v * sizeof(float);
+	return bytes;
+}
+
+double N1Graph::EstimateTime(int n, int threads) {
+	CHECK_GT(threads, 0);
+	// Each sweep evaluates the remaining candidates at every step, and a join
+	// reads the distances to the k used nodes.
+	double distances = 0;
+	for (int k = 1; k < n; ++k) {
+		distances += static_cast<double>(n - k) * (k % 2 == 0 ? k : 1);
+	}
+	// The sweeps are spread evenly over the threads.
+	int sweeps = (n + threads - 1) / threads;
+	return sweeps * distances * kSecondsPerDistance;
+}
+
+SolverPlan N1Graph::Explain(int n) const {
+	SolverPlan plan;
+	std::ostringstream explanation;
+	explanation << "  distances: the dense adjacency of the input\n";
+	plan.strategy_ = strategy_;
+	plan.threads_ = 1;
+	if (strategy_ == SolverStrategy::AUTO) {
+		int threads = executor()->concurrency();
+		double serial_seconds = EstimateTime(n, 1);
+		if (threads > 1 && n > 1 && serial_seconds >= kParallelSeconds) {
+			plan.threads_ = std::min(threads, n);
+			explanation << "  threads: the serial run would take "
+					<< serial_seconds << " s\n";
+		} else {
+			explanation << "  threads: serial, " << threads
+					<< " available, the serial run would take "
+					<< serial_seconds << " s\n";
+		}
+		// The cube is never faster than the rolling sweeps, which yield the
+		// same solution, thus it only runs when set explicitly.
+		plan.strategy_ = SolverStrategy::ROLLING;
+		explanation << "  strategy: ROLLING, O(V) state per thread\n";
+	} else {
+		explanation << "  strategy: set explicitly, run serially\n";
+	}
+	// The wider precisions and the approximate mode only exist as rolling
+	// sweeps, without the incremental bookkeeping.
+	bool rolling_only = precision_ != CostPrecision::SINGLE_PRECISION
+			|| (candidates_ > 0 && candidates_ < n - 1);
+	if (rolling_only)
+		plan.strategy_ = SolverStrategy::ROLLING;
+	// Plus the node lists of the sweeps of the other threads.
+	plan.estimated_bytes_ = EstimateMemory(n, plan.strategy_,
+			incremental_ && !rolling_only)
+			+ (plan.threads_ - 1) * 2 * static_cast<int64_t>(n) * sizeof(int);
+	plan.estimated_seconds_ = EstimateTime(n, plan.threads_);
+	if (sampling_ != StartSampling::EVERY_START && sampling_count_ > 0
+			&& sampling_count_ < n) {
+		plan.estimated_seconds_ *= static_cast<double>(sampling_count_) / n;
+		explanation << "  starts: " << sampling_count_ << " of " << n
+				<< " initial nodes\n";
+	}
+	if (precision_ != CostPrecision::SINGLE_PRECISION) {
+		if (precision_ == CostPrecision::FIXED_POINT) {
+			plan.estimated_bytes_ += static_cast<int64_t>(n) * n
+					* sizeof(int64_t);
+			explanation << "  precision: fixed-point, the rolling sweeps on "
+					"scaled 64-bit distances\n";
+		} else {
+			explanation << "  precision: double, the rolling sweeps\n";
+		}
+	}
+	if (candidates_ > 0 && candidates_ < n - 1) {
+		// The approximate sweeps evaluate k candidates per step, and keep
+		// the lists of candidates.
+		int k = candidates_;
+		plan.estimated_bytes_ += static_cast<int64_t>(n) * k * sizeof(int);
+		plan.estimated_seconds_ *= static_cast<double>(k) / n;
+		explanation << "  candidates: the " << k
+				<< " nearest neighbours of the latest node\n";
+	}
+	plan.fits_ = (budget_.memory_bytes_ <= 0
+			|| plan.estimated_bytes_ <= budget_.memory_bytes_)
+			&& (budget_.seconds_ <= 0
+					|| plan.estimated_seconds_ <= budget_.seconds_);
+	plan.explanation_ = explanation.str();
+	return plan;
+}
+
+void N1Graph::Minimize(const AdjacencyGraph& input) {
+	ScopedTimer timer(StatsPhase::MINIMIZE);
+	ScopedTrace trace(StatsPhase::MINIMIZE);
+	Reset(input);
+	int n = input.NumberOfNodes();
+	CHECK(!incremental_ || candidates_ == 0)
+			<< "The approximate mode has no incremental bookkeeping.";
+	CHECK(!incremental_ || sampling_ == StartSampling::EVERY_START)
+			<< "The incremental bookkeeping needs every initial node.";
+	CHECK(precision_ == CostPrecision::SINGLE_PRECISION
+			|| (candidates_ == 0 && !incremental_
+					&& checkpoint_location_.empty()))
+			<< "Only the exact sweeps without bookkeeping have a precision.";
+	CHECK(!input.quantized()
+			|| (candidates_ == 0 && !incremental_
+					&& checkpoint_location_.empty()
+					&& sampling_ != StartSampling::CENTRAL_STARTS
+					&& sampling_ != StartSampling::SPREAD_STARTS))
+			<< "Only the exact sweeps without bookkeeping read quantized "
+			<< "distances.";
+	SelectCandidates(input);
+	std::vector<int> starts = SelectStarts(input);
+	std::vector<int> best_nodes;
+	// The tiny point-sets skip the heap-allocated sweeps, unless a feature
+	// which only they provide is needed.
+	if (small_solver_ && n <= kSmallSolverNodes && neighbours_.empty()
+			&& precision_ == CostPrecision::SINGLE_PRECISION
+			&& !input.quantized() && !incremental_
+			&& static_cast<int>(starts.size()) == n && checkpoint_location_.empty() && !progress_
+			&& !cancellation_.cancelled()) {
+		cancelled_ = false;
+		sweeps_.clear();
+		sweep_costs_.clear();
+		cost_ = MinimizeSmall(input.adjacency(), &best_nodes);
+		precise_cost_ = cost_;
+		sampling_estimate_ = {n, n, cost_, 0};
+		BuildGraph(best_nodes);
+		return;
+	}
+	sweeps_.assign(incremental_ ? n : 0, best_nodes);
+	sweep_costs_.assign(sweeps_.size(), std::numeric_limits<float>::max());
+	SweepMonitor monitor(starts.size(), progress_, progress_interval_,
+			cancellation_);
+	Checkpoint checkpoint;
+	if (!checkpoint_location_.empty()) {
+		uint64_t fingerprint = Checkpoint::Fingerprint(input, { sampling_,
+				sampling_count_, sampling_seed_, candidates_, precision_ });
+		if (checkpoint.Read(checkpoint_location_, fingerprint, n)
+				&& checkpoint.sweeps_.size() == sweeps_.size()) {
+			LOG(INFO)<< "Resuming from " << checkpoint_location_;
+			sweeps_ = checkpoint.sweeps_;
+			sweep_costs_ = checkpoint.sweep_costs_;
+		} else {
+			checkpoint = Checkpoint();
+			checkpoint.fingerprint_ = fingerprint;
+			checkpoint.completed_.assign(n, 0);
+		}
+		monitor.set_checkpoint(&checkpoint, checkpoint_location_,
+				checkpoint_interval_, sweeps_, sweep_costs_);
+	}
+	std::vector<int> initial_nodes;
+	for (int i : starts) {
+		if (checkpoint.completed_.empty() || !checkpoint.completed_[i])
+			initial_nodes.push_back(i);
+	}
+	monitor_ = &monitor;
+	if (precision_ == CostPrecision::SINGLE_PRECISION && !input.quantized()) {
+		cost_ = Search(input, initial_nodes, std::numeric_limits<float>::max(),
+				&best_nodes);
+		precise_cost_ = cost_;
+	} else {
+		precise_cost_ = SearchPrecise(input, initial_nodes, &best_nodes);
+		cost_ = best_nodes.empty() ? std::numeric_limits<float>::max() :
+				static_cast<float>(precise_cost_);
+	}
+	monitor_ = nullptr;
+	// The sweeps of a previous run, with the same tie rule as Search.
+	const std::vector<int>& resumed = checkpoint.best_nodes_;
+	if (!resumed.empty() && resumed != best_nodes
+			&& (best_nodes.empty() || checkpoint.best_cost_ < cost_
+					|| (checkpoint.best_cost_ == cost_
+							&& resumed[0] < best_nodes[0]))) {
+		cost_ = checkpoint.best_cost_;
+		precise_cost_ = cost_;
+		best_nodes = resumed;
+	}
+	// A cancellation after the last sweep has no effect.
+	cancelled_ = monitor.cancelled() && !monitor.finished();
+	int sampled = starts.size();
+	sampling_estimate_.sampled_ = sampled;
+	sampling_estimate_.total_ = n;
+	sampling_estimate_.best_cost_ = cost_;
+	sampling_estimate_.gap_ = 0;
+	if (sampled < n && monitor.lowest(1) < std::numeric_limits<float>::max())
+		sampling_estimate_.gap_ = (monitor.lowest(1) - monitor.lowest(0))
+				* (1.f - (sampled + 1.f) / (n + 1.f));
+	if (!checkpoint_location_.empty()) {
+		if (cancelled_)
+			monitor.WriteCheckpoint();
+		else
+			std::remove(checkpoint_location_.c_str());
+	}
+	if (cancelled_) {
+		// Only the sweeps completed before the cancellation are known.
+		sweeps_.clear();
+		sweep_costs_.clear();
+		if (best_nodes.empty()) {
+			nodes_.clear();
+			return;
+		}
+	}
+	// The approximate sweeps accumulate the joins in another order.
+	if (!neighbours_.empty()) {
+		cost_ = Evaluate(input, best_nodes);
+		precise_cost_ = cost_;
 	}
 //	int optimum_layer = FindOptimalLayer(dp);
 	CHECK_EQ(best_nodes.size(),input.NumberOfNodes());
 	BuildGraph(best_nodes);
 }
 
+std::future<bool> N1Graph::MinimizeAsync(const AdjacencyGraph& input,
+		Executor* executor) {
+	if (executor == nullptr)
+		executor = this->executor();
+	std::shared_ptr<std::promise<bool> > promise = std::make_shared<
+			std::promise<bool> >();
+	executor->Submit([this, &input, promise]() {
+		Minimize(input);
+		promise->set_value(!cancelled_);
+	});
+	return promise->get_future();
+}
+
+bool N1Graph::Minimize(const AdjacencyGraph& input,
+		const std::vector<int>& incumbent, float reference_cost,
+		float threshold) {
+	ScopedTimer timer(StatsPhase::MINIMIZE);
+	ScopedTrace trace(StatsPhase::MINIMIZE);
+	CHECK_EQ(incumbent.size(), input.NumberOfNodes());
+	CHECK_GE(threshold, 0);
+	CHECK_EQ(precision_, CostPrecision::SINGLE_PRECISION)
+			<< "The tracking mode evaluates the incumbent in float.";
+	CHECK(!input.quantized()) << "The tracking mode reads float distances.";
+	Reset(input);
+	SelectCandidates(input);
+	cancelled_ = false;
+	// A warm start does not sweep every initial node.
+	sweeps_.clear();
+	sweep_costs_.clear();
+	std::vector<int> best_nodes = incumbent;
+	float best_cost = Evaluate(input, incumbent);
+	// A sweep from the previous initial node repairs the incumbent when the
+	// points moved enough to change the greedy choices.
+	std::vector<int> initial_nodes(1, incumbent[0]);
+	std::vector<int> sweep_nodes;
+	float sweep_cost = Search(input, initial_nodes, best_cost, &sweep_nodes);
+	if (sweep_cost < best_cost) {
+		best_cost = sweep_cost;
+		best_nodes = sweep_nodes;
+	}
+	bool warm = std::fabs(best_cost - reference_cost)
+			<= threshold * std::fabs(reference_cost);
+	if (!warm) {
+		// The full search, bounded by the best solution so far. The bound
+		// only prunes the sweeps strictly more expensive than it, so that the
+		// ties resolve like in Minimize and a sweep is preferred over an
+		// incumbent of the same cost.
+		initial_nodes.clear();
+		for (int i = 0; i < static_cast<int>(input.NumberOfNodes()); ++i) {
+			initial_nodes.push_back(i);
+		}
+		std::vector<int> full_nodes;
+		sweep_cost = Search(input, initial_nodes,
+				std::nextafter(best_cost, std::numeric_limits<float>::max()),
+				&full_nodes);
+		if (!full_nodes.empty() && sweep_cost <= best_cost) {
+			best_cost = sweep_cost;
+			best_nodes = full_nodes;
+		}
+	}
+	cost_ = neighbours_.empty() ? best_cost : Evaluate(input, best_nodes);
+	precise_cost_ = cost_;
+	BuildGraph(best_nodes);
+	return warm;
+}
+
+void N1Graph::MinimizeHierarchical(const AdjacencyGraph& input,
+		int leaf_size, int compare_below) {
+	ScopedTimer timer(StatsPhase::MINIMIZE);
+	ScopedTrace trace(StatsPhase::MINIMIZE);
+	int n = input.NumberOfNodes();
+	CHECK_GT(n, 2);
+	CHECK_GE(leaf_size, 3);
+	CHECK(!input.quantized()) << "The leaves read float distances.";
+	InitializeResult(input);
+	cancelled_ = false;
+	sweeps_.clear();
+	sweep_costs_.clear();
+	std::vector<std::vector<int> > leaves = Partition::Leaves(
+			input.adjacency(), leaf_size);
+	VLOG(1) << "[Hierarchical] " << leaves.size() << " leaves of at most "
+			<< leaf_size << " nodes";
+	// The leaves are minimized serially, each one in a task.
+	std::vector<std::vector<int> > orders(leaves.size());
+	executor()->ParallelFor(0, leaves.size(),
+			[this, &input, &leaves, &orders](int l) {
+				const std::vector<int>& leaf = leaves[l];
+				int m = leaf.size();
+				if (m <= 2) {
+					orders[l] = leaf;
+					return;
+				}
+				AdjacencyGraph subgraph(m, GraphType::UNDIRECTED);
+				for (int i = 0; i < m; ++i) {
+					for (int j = 0; j < m; ++j) {
+						(*subgraph.mutable_adjacency())(i, j) =
+								input.adjacency()(leaf[i], leaf[j]);
+					}
+				}
+				N1Graph solver;
+				solver.set_strategy(strategy_ == SolverStrategy::CUBE ?
+						SolverStrategy::CUBE : SolverStrategy::ROLLING);
+				solver.set_candidates(std::min(candidates_, m - 1));
+				solver.Minimize(subgraph);
+				for (int node : solver.nodes()) {
+					orders[l].push_back(leaf[node]);
+				}
+			});
+	std::vector<int> nodes;
+	std::vector<int> boundaries;
+	for (const std::vector<int>& order : orders) {
+		if (!nodes.empty())
+			boundaries.push_back(nodes.size());
+		nodes.insert(nodes.end(), order.begin(), order.end());
+	}
+	// RepairWindow keeps the isolate/join alternation by reordering windows
+	// of even length, half of them on each side of a boundary, unless they
+	// are clipped by the ends of the sequence.
+	int half = std::min(kRepairWindow, leaf_size) / 2;
+	int repaired = 0;
+	for (int boundary : boundaries) {
+		if (RepairWindow(input, &nodes, std::max(1, boundary - half),
+				std::min(n, boundary + half)))
+			++repaired;
+	}
+	VLOG(1) << "[Hierarchical] " << repaired << " of " << boundaries.size()
+			<< " boundaries repaired";
+	cost_ = Evaluate(input, nodes);
+	precise_cost_ = cost_;
+	sampling_estimate_ = {n, n, cost_, 0};
+	if (n <= compare_below) {
+		N1Graph full;
+		full.set_executor(executor_);
+		full.set_strategy(strategy_);
+		full.set_budget(budget_);
+		full.Minimize(input);
+		sampling_estimate_.gap_ = cost_ - full.cost();
+		VLOG(1) << "[Hierarchical] " << cost_ / full.cost()
+				<< " times the cost of the full search";
+	}
+	BuildGraph(nodes);
+}
+
+int N1Graph::Refine(const AdjacencyGraph& input, int max_moves,
+		double seconds) {
+	ScopedTimer timer(StatsPhase::REFINE);
+	ScopedTrace trace(StatsPhase::REFINE);
+	CHECK_EQ(nodes_.size(), input.NumberOfNodes());
+	CHECK(!input.quantized()) << "The local search reads float distances.";
+	LocalSearch search(input.adjacency(), nodes_);
+	int moves = search.Run(max_moves, seconds);
+	Stats::Increment(StatsCounter::MOVES_APPLIED, moves);
+	if (moves == 0)
+		return 0;
+	// The incremental bookkeeping no longer matches the solution.
+	sweeps_.clear();
+	sweep_costs_.clear();
+	std::vector<int> nodes = search.nodes();
+	cost_ = Evaluate(input, nodes);
+	precise_cost_ = cost_;
+	InitializeResult(input);
+	BuildGraph(nodes);
+	return moves;
+}
+
+bool N1Graph::RepairWindow(const AdjacencyGraph& input,
+		std::vector<int>* nodes, int begin, int end) {
+	const Matrix<float>& distances = input.adjacency();
+	std::vector<int>& sequence = *nodes;
+	int n = sequence.size();
+	int w = end - begin;
+	if (w < 2)
+		return false;
+	// The cost of joining each node of the window after the fixed prefix.
+	std::vector<float> prefix(w, 0);
+	for (int i = 0; i < w; ++i) {
+		for (int k = 0; k < begin; ++k) {
+			prefix[i] += distances(sequence[begin + i], sequence[k]);
+		}
+	}
+	std::vector<int> window(sequence.begin() + begin, sequence.begin() + end);
+	// Position k is an isolate when odd and a join when even.
+	auto step = [&](const std::vector<int>& placed, int i, int k) {
+		if (k % 2 == 1) {
+			int previous = placed.empty() ? sequence[begin - 1] : placed.back();
+			return distances(window[i], previous);
+		}
+		float cost = prefix[i];
+		for (int j : placed) {
+			cost += distances(window[i], j);
+		}
+		return cost;
+	};
+	auto tail = [&](const std::vector<int>& placed) {
+		if (end < n && end % 2 == 1)
+			return distances(sequence[end], placed.back());
+		return 0.f;
+	};
+	std::vector<int> current;
+	float current_cost = 0;
+	for (int i = 0; i < w; ++i) {
+		current_cost += step(current, i, begin + i);
+		current.push_back(window[i]);
+	}
+	current_cost += tail(current);
+	std::vector<int> greedy;
+	std::vector<bool> used(w, false);
+	float greedy_cost = 0;
+	for (int k = begin; k < end; ++k) {
+		int best = -1;
+		float best_step = std::numeric_limits<float>::max();
+		for (int i = 0; i < w; ++i) {
+			if (used[i])
+				continue;
+			float cost = step(greedy, i, k);
+			if (cost < best_step) {
+				best_step = cost;
+				best = i;
+			}
+		}
+		used[best] = true;
+		greedy_cost += best_step;
+		greedy.push_back(window[best]);
+	}
+	greedy_cost += tail(greedy);
+	if (greedy_cost >= current_cost)
+		return false;
+	std::copy(greedy.begin(), greedy.end(), sequence.begin() + begin);
+	return true;
+}
+
 }  /* namespace n1graph */
@@ -17,10 +17,164 @@
 #ifndef MIN_WEIGHT_N1_HPP_
 #define MIN_WEIGHT_N1_HPP_
 
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
 #include <adjacency_graph.hpp>
+#include <executor.hpp>
 
 namespace n1graph {
 
+/**
+ * The implementations of the sweeps run by Minimize. All of them yield the
+ * same solution, node by node and bit by bit in the cost.
+ */
+enum SolverStrategy {
+	// The Dynamic Programming cube of the original implementation, kept as
+	// the reference for the other strategies and only run when set
+	// explicitly. Space Complexity: O(V^3).
+	CUBE,
+	// Keeps only the running cost and the used nodes of the current sweep,
+	// the default. Space Complexity: O(V).
+	ROLLING,
+	// Chosen for each input by N1Graph::Explain within the budget.
+	AUTO
+};
+
+/**
+ * The resources a run of Minimize may use. A non-positive value means no
+ * limit.
+ */
+struct SolverBudget {
+	SolverBudget() :
+			memory_bytes_(0), seconds_(0) {
+	}
+
+	int64_t memory_bytes_;
+	double seconds_;
+};
+
+/**
+ * How a run of Minimize is carried out, as selected by N1Graph::Explain.
+ */
+struct SolverPlan {
+	SolverPlan() :
+			strategy_(SolverStrategy::ROLLING), threads_(1), estimated_bytes_(0),
+			estimated_seconds_(0), fits_(true) {
+	}
+
+	// The strategy of the sweeps, never AUTO.
+	SolverStrategy strategy_;
+	// The number of threads the sweeps are spread over.
+	int threads_;
+	// The estimated peak memory and wall time of the run.
+	int64_t estimated_bytes_;
+	double estimated_seconds_;
+	// Whether the estimates are within the budget.
+	bool fits_;
+	// The reason of each choice, one per line.
+	std::string explanation_;
+
+	/**
+	 * Returns the plan and the reasons of its choices in a human readable
+	 * form.
+	 */
+	std::string ToString() const;
+};
+
+/**
+ * The arithmetic in which the sweeps of Minimize accumulate and compare the
+ * costs.
+ */
+enum CostPrecision {
+	// The float distances summed in float, as the CUBE strategy.
+	SINGLE_PRECISION,
+	// The float distances summed in double.
+	DOUBLE_PRECISION,
+	// The distances rounded to 64-bit integers with a power-of-two scale
+	// chosen so that no sum exceeds 2^53, i.e. every sum and comparison is
+	// exact and independent of the order of the accumulation.
+	FIXED_POINT
+};
+
+/**
+ * The initial nodes swept by Minimize.
+ */
+enum StartSampling {
+	// Every node, i.e. the exact search.
+	EVERY_START,
+	// A uniform sample drawn with a seed.
+	RANDOM_STARTS,
+	// The nodes with the lowest sum of distances to the others.
+	CENTRAL_STARTS,
+	// Farthest-point sampling from the most central node.
+	SPREAD_STARTS
+};
+
+/**
+ * The outcome of a sampled run of Minimize. The gap to the full search is
+ * extrapolated from the two best sampled costs, assuming that the density of
+ * the costs is uniform near the minimum: the expected spacing of the m lowest
+ * order statistics shrinks to the one of n draws.
+ */
+struct SamplingEstimate {
+	// The initial nodes swept out of all the nodes.
+	int sampled_;
+	int total_;
+	float best_cost_;
+	// The expected improvement of the full search over best_cost_, zero if
+	// every node was swept or a single sweep completed. A pruned sweep only
+	// bounds its cost from below, so the estimate errs on the high side.
+	// After MinimizeHierarchical, the exact improvement when the full search
+	// was compared, negative if it is more expensive, and zero otherwise.
+	float gap_;
+};
+
+/**
+ * The progress of a run of Minimize, reported after the sweeps of the initial
+ * nodes.
+ */
+struct MinimizeProgress {
+	// The initial nodes swept, or pruned, out of the total.
+	int completed_;
+	int total_;
+	// The cost of the best complete sweep so far, the maximum float if none.
+	float best_cost_;
+};
+
+typedef std::function<void(const MinimizeProgress&)> ProgressCallback;
+
+/**
+ * A flag shared by the copies of a token, which asks a run of Minimize to
+ * stop. The run checks it between layers, i.e. after each node added to a
+ * sweep.
+ */
+class CancellationToken {
+public:
+	CancellationToken() :
+			cancelled_(std::make_shared<std::atomic<bool> >(false)) {
+	}
+
+	void Cancel() const {
+		cancelled_->store(true, std::memory_order_relaxed);
+	}
+
+	bool cancelled() const {
+		return cancelled_->load(std::memory_order_relaxed);
+	}
+
+private:
+	std::shared_ptr<std::atomic<bool> > cancelled_;
+};
+
+class SweepMonitor;
+
 class N1Graph {
 public:
 	N1Graph();
@@ -33,11 +187,320 @@ public:
 	 *	  Minimum-Weight Maximum-Entropy Problem. 10th IAPR-TC15 Workshop
 	 * 	  on Graph-based Representations in Pattern Recognition (GbR2015).
 	 *
-	 * Time Complexity: O(V^3 * E).
-	 * Space Complexity: O(V^3).
+	 * Time Complexity: O(V^4), i.e. O(V^2 * E), for the sweeps of every
+	 * strategy, or O(V^3 * k) with set_candidates.
+	 * Space Complexity: O(V^3) with SolverStrategy::CUBE, O(V) per thread
+	 * with SolverStrategy::ROLLING, plus the O(V^2) fixed-point distances
+	 * with CostPrecision::FIXED_POINT. SolverStrategy::AUTO never picks the
+	 * CUBE.
 	 */
 	void Minimize(const AdjacencyGraph& input);
 
+	/**
+	 * Tracking mode of Minimize, which warm-starts from a previous solution,
+	 * e.g. the one of the previous frame of a moving point-set. The incumbent
+	 * order is evaluated first, then a sweep is run from its initial node. If
+	 * the best cost differs from the reference cost by at most threshold
+	 * (relative), it is accepted. Otherwise, all the initial nodes are
+	 * searched, pruning every partial solution which exceeds the incumbent,
+	 * and the result is the one of Minimize unless the incumbent order is
+	 * strictly cheaper.
+	 *
+	 * Time Complexity: O(V^2 * E) when accepted, the one of Minimize
+	 * otherwise.
+	 *
+	 * @param input: The complete graph of the point-set.
+	 * @param incumbent: A join/isolate sequence of all the nodes of input.
+	 * @param reference_cost: The cost of the previous solution.
+	 * @param threshold: The allowed relative change of the cost.
+	 * @return true if the full search was avoided.
+	 */
+	bool Minimize(const AdjacencyGraph& input,
+			const std::vector<int>& incumbent, float reference_cost,
+			float threshold);
+
+	/**
+	 * Runs Minimize as a task of the executor. Neither input nor this graph
+	 * may be used until the future is ready.
+	 *
+	 * @param input: The complete graph of the point-set.
+	 * @param executor: The executor of the task, nullptr for the one of this
+	 * graph.
+	 * @return a future holding false if the run was cancelled.
+	 */
+	std::future<bool> MinimizeAsync(const AdjacencyGraph& input,
+			Executor* executor = nullptr);
+
+	/**
+	 * A multi-level approximation of Minimize for point-sets too large for
+	 * the exact search. The input is split by Partition::Leaves, each leaf is
+	 * minimized independently in parallel with the current strategy and
+	 * candidates, and the sequences of the leaves are concatenated. A repair
+	 * pass then reorders the nodes around each boundary between two leaves
+	 * greedily, keeping the new order only when it is cheaper. cost() is the
+	 * exact cost of the sequence found. On point-sets small enough, the full
+	 * search is also run, and sampling_estimate() holds the gap between both
+	 * costs.
+	 *
+	 * Time Complexity: O(V * L^3) for the leaves with the rolling sweeps,
+	 * plus O(V^2) to evaluate the sequence, where L is the leaf size. The
+	 * comparison adds the time of Minimize.
+	 *
+	 * @param input: The complete graph of the point-set.
+	 * @param leaf_size: The maximum number of nodes minimized together.
+	 * @param compare_below: The full search is run when the point-set has at
+	 * most this number of nodes.
+	 */
+	void MinimizeHierarchical(const AdjacencyGraph& input, int leaf_size,
+			int compare_below = 0);
+
+	/**
+	 * Refines the solution of the latest run of Minimize by a local search of
+	 * swaps and relocations of nodes, see LocalSearch, and rebuilds the
+	 * graph. A cheap approximate run, e.g. with set_candidates, followed by
+	 * Refine often beats the exact sweeps in both cost and time.
+	 *
+	 * Time Complexity: O(V^3) per pass over all the moves.
+	 *
+	 * @param input: The complete graph previously minimized.
+	 * @param max_moves: The number of moves to apply, non-positive for no
+	 * limit.
+	 * @param seconds: The time to spend, non-positive for no limit.
+	 * @return the number of moves applied.
+	 */
+	int Refine(const AdjacencyGraph& input, int max_moves, double seconds);
+
+	/**
+	 * Reports the progress of Minimize to callback, from the thread which
+	 * completed the sweep, every interval initial nodes and after the last
+	 * one. The calls are serialized.
+	 */
+	void set_progress(const ProgressCallback& callback, int interval) {
+		progress_ = callback;
+		progress_interval_ = interval;
+	}
+
+	/**
+	 * Lets token stop Minimize. A cancelled run keeps the best complete sweep
+	 * found so far, if any, and drops the incremental bookkeeping.
+	 */
+	void set_cancellation(const CancellationToken& token) {
+		cancellation_ = token;
+	}
+
+	/**
+	 * Lets Minimize resume from, and save its state into, a checkpoint file.
+	 * The state is written every interval initial nodes and when the run is
+	 * cancelled, and the file is removed once the run completes. A run whose
+	 * input differs from the one of the checkpoint starts afresh. A resumed
+	 * run finds the same solution as an uninterrupted one.
+	 *
+	 * @param location: The checkpoint file, empty to disable checkpoints.
+	 * @param interval: The number of initial nodes between two writes.
+	 */
+	void set_checkpoint(const std::string& location, int interval) {
+		checkpoint_location_ = location;
+		checkpoint_interval_ = interval;
+	}
+
+	/**
+	 * Turns Minimize into an approximation in which each step of a sweep only
+	 * evaluates the unused nodes among the k nearest neighbours of the latest
+	 * node, and scans all the nodes only when none of them is left. cost()
+	 * remains the exact cost of the sequence found, so that it can be
+	 * compared with the one of the exact mode. With k >= V - 1 every node is
+	 * a candidate, thus the exact mode is run. It cannot be combined with
+	 * the incremental bookkeeping.
+	 *
+	 * Time Complexity: O(V^3 * k) instead of O(V^4) for the sweeps.
+	 *
+	 * @param k: The number of candidates per step, 0 for the exact mode.
+	 */
+	void set_candidates(int k) {
+		candidates_ = k;
+	}
+
+	int candidates() const {
+		return candidates_;
+	}
+
+	/**
+	 * Makes Minimize sweep only a subset of the initial nodes, which scales
+	 * down its time by count / V. The incremental bookkeeping needs every
+	 * initial node.
+	 *
+	 * @param sampling: How the initial nodes are chosen.
+	 * @param count: The number of initial nodes swept.
+	 * @param seed: The seed of RANDOM_STARTS.
+	 */
+	void set_start_sampling(StartSampling sampling, int count,
+			unsigned int seed) {
+		sampling_ = sampling;
+		sampling_count_ = count;
+		sampling_seed_ = seed;
+	}
+
+	/**
+	 * Returns the outcome of the latest run of Minimize with respect to the
+	 * sampling of its initial nodes.
+	 */
+	const SamplingEstimate& sampling_estimate() const {
+		return sampling_estimate_;
+	}
+
+	/**
+	 * Selects the arithmetic of the sweeps of Minimize. Any precision but
+	 * SINGLE_PRECISION runs the rolling sweeps and cannot be combined with the
+	 * approximate mode, the incremental bookkeeping, a checkpoint or the
+	 * tracking mode, which keep float costs. FIXED_POINT needs 8 bytes per
+	 * pair of nodes for the scaled distances.
+	 */
+	void set_precision(CostPrecision precision) {
+		precision_ = precision;
+	}
+
+	CostPrecision precision() const {
+		return precision_;
+	}
+
+	/**
+	 * Returns the cost of the solution found by Minimize in the precision of
+	 * the run, which cost() rounds to a float.
+	 */
+	double precise_cost() const {
+		return precise_cost_;
+	}
+
+	/**
+	 * Lets Minimize run the point-sets of at most 64 nodes with SmallSolver,
+	 * which finds the same solution, unless the approximate mode, a sampling
+	 * of the initial nodes, the incremental bookkeeping, a checkpoint, a
+	 * progress callback or a cancelled token is set. It is enabled by default.
+	 */
+	void set_small_solver(bool enabled) {
+		small_solver_ = enabled;
+	}
+
+	/**
+	 * Sets the pages and the NUMA placement of the cube of the CUBE strategy
+	 * and of the fixed-point distances. Under FIRST_TOUCH, the rows of the
+	 * fixed-point distances are written by the executor of this object unless
+	 * the policy sets one, whereas the cube, which one thread sweeps, stays
+	 * local to it. The input is placed by AdjacencyGraph::set_allocation_policy.
+	 */
+	void set_allocation_policy(const AllocationPolicy& policy) {
+		allocation_policy_ = policy;
+	}
+
+	/**
+	 * Whether the latest run of Minimize was cancelled.
+	 */
+	bool cancelled() const {
+		return cancelled_;
+	}
+
+	/**
+	 * Estimates the peak number of bytes of a run of Minimize on n points,
+	 * including the input and result graphs, before it starts. A caller may
+	 * reject the run or downgrade it to SolverStrategy::ROLLING when the
+	 * estimate exceeds its budget.
+	 *
+	 * Time Complexity: O(1).
+	 */
+	static int64_t EstimateMemory(int n, SolverStrategy strategy,
+			bool incremental);
+
+	/**
+	 * Estimates the wall time of a run of Minimize on n points whose sweeps
+	 * are spread over the given number of threads. The throughput is the one
+	 * measured on a release build, thus the estimate is only indicative.
+	 *
+	 * Time Complexity: O(1).
+	 */
+	static double EstimateTime(int n, int threads);
+
+	/**
+	 * Returns how Minimize would run on n points with the current strategy
+	 * and budget. With SolverStrategy::AUTO, the rolling sweeps are spread
+	 * over the threads of the executor when a serial run is long enough to pay
+	 * off. The explicit strategies run serially.
+	 *
+	 * Time Complexity: O(1).
+	 */
+	SolverPlan Explain(int n) const;
+
+	/**
+	 * Returns the plan of the latest run.
+	 */
+	const SolverPlan& plan() const {
+		return plan_;
+	}
+
+	/**
+	 * Sets the executor the sweeps run on. nullptr, the default, stands for
+	 * Executor::Default().
+	 */
+	void set_executor(Executor* executor) {
+		executor_ = executor;
+	}
+
+	void set_budget(const SolverBudget& budget) {
+		budget_ = budget;
+	}
+
+	const SolverBudget& budget() const {
+		return budget_;
+	}
+
+	void set_strategy(SolverStrategy strategy) {
+		strategy_ = strategy;
+	}
+
+	SolverStrategy strategy() const {
+		return strategy_;
+	}
+
+	/**
+	 * Keeps the sweep of every initial node computed by Minimize, so that
+	 * Insert and Remove can reproduce a full recomputation. It must be set
+	 * before Minimize.
+	 *
+	 * Space Complexity: O(V^2).
+	 */
+	void set_incremental(bool incremental) {
+		incremental_ = incremental;
+	}
+
+	/**
+	 * Appends a point to input and updates the solution. For each initial
+	 * node, only the suffix of the sweep starting where the new node would
+	 * have been selected is recomputed, and a sweep is run for the new node.
+	 * Without the incremental bookkeeping, only the suffix of the current
+	 * solution is repaired.
+	 *
+	 * Time Complexity: O(V^3) plus the recomputed suffixes.
+	 *
+	 * @param input: The complete graph previously minimized.
+	 * @param location: The location of the new point.
+	 * @return true if the solution provably equals the one of Minimize.
+	 */
+	bool Insert(AdjacencyGraph* input, const Vector<float>& location);
+
+	/**
+	 * Removes a point from input and updates the solution. The nodes with a
+	 * higher index are shifted down by one. For each initial node, only the
+	 * suffix of the sweep starting at the position of the removed node is
+	 * recomputed. Without the incremental bookkeeping, only the suffix of the
+	 * current solution is repaired.
+	 *
+	 * Time Complexity: O(V^3) plus the recomputed suffixes.
+	 *
+	 * @param input: The complete graph previously minimized.
+	 * @param node: The index of the point to be removed.
+	 * @return true if the solution provably equals the one of Minimize.
+	 */
+	bool Remove(AdjacencyGraph* input, int node);
+
 	/**
 	 * Given the order of nodes to be added into the graphs, build the graph.
 	 *
@@ -52,10 +515,234 @@ public:
 		return result_;
 	}
 
+	/**
+	 * Returns the order in which the nodes were added into the G_N graph, i.e.
+	 * the join/isolate sequence used by BuildGraph. The position of a node in
+	 * this list determines its degree in the result graph, therefore it is the
+	 * ordering used for registration.
+	 */
+	const std::vector<int>& nodes() const {
+		return nodes_;
+	}
+
+	/**
+	 * Returns the cost of the solution found by Minimize.
+	 */
+	float cost() const {
+		return cost_;
+	}
+
+	/**
+	 * Computes the cost of any join/isolate sequence, e.g. a cached,
+	 * warm-started or external one, with the same accumulation used by
+	 * Minimize, so that it equals cost() for the sequence Minimize finds. A
+	 * join reads the distances to all the previous nodes, so no evaluation
+	 * can read fewer than O(V^2) of them. The units of a quantized input are
+	 * summed exactly, as in Minimize.
+	 *
+	 * Time Complexity: O(V^2).
+	 *
+	 * @param input: The complete graph of the point-set.
+	 * @param nodes: A permutation of the nodes of input.
+	 */
+	static float Evaluate(const AdjacencyGraph& input,
+			const std::vector<int>& nodes);
+
+	/**
+	 * Evaluate with the float distances summed in double, e.g. to check the
+	 * precise_cost() of the wider precisions. The units of a quantized input
+	 * are summed exactly, as in Evaluate.
+	 *
+	 * Time Complexity: O(V^2).
+	 */
+	static double EvaluatePrecise(const AdjacencyGraph& input,
+			const std::vector<int>& nodes);
+
+	/**
+	 * Evaluates many sequences of the same point-set in parallel.
+	 *
+	 * Time Complexity: O(K * V^2) for K sequences.
+	 *
+	 * @param executor: The executor of the parallel loop, nullptr for
+	 * Executor::Default().
+	 * @return the cost of each sequence.
+	 */
+	static std::vector<float> Evaluate(const AdjacencyGraph& input,
+			const std::vector<std::vector<int> >& orders, Executor* executor =
+					nullptr);
+
 	virtual ~N1Graph();
 
 private:
 
+	/**
+	 * Clears the result graph and copies the locations of input into it.
+	 *
+	 * Time Complexity: O(V^2).
+	 */
+	void InitializeResult(const AdjacencyGraph& input);
+
+	/**
+	 * Reorders nodes[begin, end) greedily given the nodes before them, which
+	 * only changes the cost of these positions and of the isolate step right
+	 * after them.
+	 *
+	 * Time Complexity: O(V * W + W^3) for a window of W nodes.
+	 *
+	 * @return true if the reordered sequence is cheaper, and kept.
+	 */
+	static bool RepairWindow(const AdjacencyGraph& input,
+			std::vector<int>* nodes, int begin, int end);
+
+	/**
+	 * Completes a join/isolate sequence greedily, i.e. given its first nodes,
+	 * it makes the same choices as the sweep of Minimize for the remaining
+	 * ones.
+	 *
+	 * Time Complexity: O(V^2 * E).
+	 *
+	 * @param nodes: A non-empty prefix of the sequence, completed in place.
+	 * @param bound: The sequence is abandoned, i.e. left incomplete, as soon
+	 * as its partial cost reaches the bound.
+	 * @param monitor: The sequence is also abandoned when its run is
+	 * cancelled.
+	 * @return the cost of the sequence.
+	 */
+	static float Complete(const AdjacencyGraph& input, std::vector<int>* nodes,
+			float bound = std::numeric_limits<float>::max(),
+			const SweepMonitor* monitor = nullptr);
+
+	/**
+	 * Complete with the distances of weights, accumulated and compared in
+	 * Cost. Complete is the instantiation for float.
+	 */
+	template<typename Cost, typename Weight>
+	static Cost CompleteIn(const Matrix<Weight>& weights,
+			std::vector<int>* nodes, Cost bound, const SweepMonitor* monitor);
+
+	/**
+	 * The approximation of Complete which only evaluates the unused nodes
+	 * among the k nearest neighbours of the latest node, or all of them if
+	 * there is none.
+	 *
+	 * Time Complexity: O(V^2 * k).
+	 *
+	 * @param neighbours: The k nearest neighbours of each node, row by row.
+	 */
+	static float CompleteNearest(const AdjacencyGraph& input,
+			const std::vector<int>& neighbours, int k, std::vector<int>* nodes,
+			float bound, const SweepMonitor* monitor);
+
+	/**
+	 * Returns the k nearest neighbours of each node, row by row, the ties
+	 * being resolved by the index of the node.
+	 *
+	 * Time Complexity: O(V^2 * log(k)).
+	 */
+	static std::vector<int> NearestNeighbours(const AdjacencyGraph& input,
+			int k);
+
+	/**
+	 * Selects the best sweep kept for incremental updates and builds it.
+	 */
+	void BuildBestSweep();
+
+	Executor* executor() const {
+		return executor_ != nullptr ? executor_ : Executor::Default();
+	}
+
+	// The allocation policy of the workspaces, written by executor() unless
+	// the policy sets its own executor.
+	AllocationPolicy workspace_policy() const {
+		AllocationPolicy policy = allocation_policy_;
+		if (policy.executor_ == nullptr)
+			policy.executor_ = executor();
+		return policy;
+	}
+
+	// The allocation policy of the workspaces swept by a single thread, e.g.
+	// the cube. Their pages stay on the node of that thread under FIRST_TOUCH.
+	AllocationPolicy serial_workspace_policy() const {
+		AllocationPolicy policy = allocation_policy_;
+		if (policy.numa_ == NumaPolicy::FIRST_TOUCH)
+			policy.numa_ = NumaPolicy::LOCAL_NODE;
+		return policy;
+	}
+
+	/**
+	 * Returns the initial nodes selected by the start sampling, in increasing
+	 * order so that ties are resolved as in the full search.
+	 *
+	 * Time Complexity: O(V^2) for CENTRAL_STARTS and SPREAD_STARTS, O(V)
+	 * otherwise.
+	 */
+	std::vector<int> SelectStarts(const AdjacencyGraph& input) const;
+
+	/**
+	 * Computes the candidates of the approximate mode for input, if enabled.
+	 *
+	 * Time Complexity: O(V^2 * log(k)).
+	 */
+	void SelectCandidates(const AdjacencyGraph& input);
+
+	/**
+	 * Prepares result_ to receive the edges of a solution for input, and
+	 * selects the plan of the run.
+	 */
+	void Reset(const AdjacencyGraph& input);
+
+	/**
+	 * Runs the sweep for each of the initial nodes with the selected
+	 * strategy. A sweep is abandoned as soon as its partial cost reaches the
+	 * bound. Ties are resolved in favour of the first initial node.
+	 *
+	 * Time Complexity: O(I * V^2 * E) for I initial nodes.
+	 *
+	 * @return the best cost, or the maximum float if every sweep was pruned,
+	 * in which case best_nodes is left untouched.
+	 */
+	float Search(const AdjacencyGraph& input,
+			const std::vector<int>& initial_nodes, float bound,
+			std::vector<int>* best_nodes);
+
+	/**
+	 * The CUBE strategy of Search.
+	 *
+	 * Space Complexity: O(I * V^2).
+	 */
+	float SearchCube(const AdjacencyGraph& input,
+			const std::vector<int>& initial_nodes, float bound,
+			std::vector<int>* best_nodes);
+
+	/**
+	 * The ROLLING strategy of Search. The initial nodes are swept by the
+	 * threads of the plan.
+	 *
+	 * Space Complexity: O(V) per thread.
+	 */
+	float SearchRolling(const AdjacencyGraph& input,
+			const std::vector<int>& initial_nodes, float bound,
+			std::vector<int>* best_nodes);
+
+	/**
+	 * The rolling sweeps in the arithmetic of Cost.
+	 *
+	 * @param unit: The cost of one unit of Cost, to report the sweeps.
+	 * @param sweep: Completes a sequence from its initial node.
+	 */
+	template<typename Cost, typename Sweep>
+	Cost SearchRollingIn(int n, const std::vector<int>& initial_nodes,
+			double unit, std::vector<int>* best_nodes, Sweep sweep);
+
+	/**
+	 * Runs the rolling sweeps in the precision of the run, without bound.
+	 *
+	 * @return the best cost, or the maximum double if there is none.
+	 */
+	double SearchPrecise(const AdjacencyGraph& input,
+			const std::vector<int>& initial_nodes,
+			std::vector<int>* best_nodes);
+
 	/**
 	 * Once the Dynamic Programming method has computed the
 	 * optimum solution. We need to trace back from the solution
@@ -75,6 +762,61 @@ private:
 	 */
 	AdjacencyGraph result_;
 
+	/**
+	 * The join/isolate sequence which generated result_.
+	 *
+	 * Space Complexity: O(V).
+	 */
+	std::vector<int> nodes_;
+
+	// The cost of nodes_.
+	float cost_;
+
+	SolverStrategy strategy_;
+
+	// The executor set by set_executor, if any.
+	Executor* executor_;
+
+	// The resources allowed to a run and the plan of the latest run.
+	SolverBudget budget_;
+	SolverPlan plan_;
+
+	// The observers of a run, and the monitor of the current run, if any.
+	ProgressCallback progress_;
+	int progress_interval_;
+	CancellationToken cancellation_;
+	SweepMonitor* monitor_;
+	bool cancelled_;
+
+	// The checkpoint file of Minimize, if any.
+	std::string checkpoint_location_;
+	int checkpoint_interval_;
+
+	// The number of candidates per step of the approximate mode, 0 for the
+	// exact one, and the nearest neighbours of the current input.
+	int candidates_;
+	std::vector<int> neighbours_;
+
+	// The arithmetic of the sweeps and the cost in it.
+	CostPrecision precision_;
+	double precise_cost_;
+	// Whether Minimize may run SmallSolver.
+	bool small_solver_;
+	// How the workspace matrices of the sweeps are placed.
+	AllocationPolicy allocation_policy_;
+	// The sampling of the initial nodes and its outcome in the latest run.
+	StartSampling sampling_;
+	int sampling_count_;
+	unsigned int sampling_seed_;
+	SamplingEstimate sampling_estimate_;
+
+	// Whether Minimize keeps the sweep of every initial node.
+	bool incremental_;
+
+	// The sweep of each initial node and its cost, indexed by initial node.
+	std::vector<std::vector<int> > sweeps_;
+	std::vector<float> sweep_costs_;
+
 };
 
 }  // namespace n1graph
@@ -0,0 +1,270 @@
+/*
+ * Copyright 2014 Samuel de Sousa
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <glog/logging.h>
+
+#include <adjacency_graph.hpp>
+#include <csv_reader.hpp>
+#include <generator.hpp>
+#include <matching.hpp>
+#include <n1graph.hpp>
+#include <text_writer.hpp>
+
+using n1graph::AdjacencyGraph;
+using n1graph::CSVReader;
+using n1graph::Generator;
+using n1graph::Matching;
+using n1graph::N1Graph;
+using n1graph::TextWriter;
+using n1graph::Vector;
+
+namespace {
+
+// The kind of synthetic point-set, the second argument of every benchmark.
+enum PointSet {
+	UNIFORM, BLOBS, POLYGON
+};
+
+std::vector<Vector<float> > Points(int n, int point_set, unsigned int seed) {
+	switch (point_set) {
+	case BLOBS:
+		return Generator::Blobs(n, 8, 100.f, 4.f, seed);
+	case POLYGON:
+		return Generator::RegularPolygon(n, 100.f);
+	default:
+		return Generator::Uniform(n, 100.f, seed);
+	}
+}
+
+void PointSets(benchmark::internal::Benchmark* benchmark, int min_n,
+		int max_n) {
+	benchmark->ArgNames({"n", "set"});
+	for (int set : {UNIFORM, BLOBS, POLYGON}) {
+		for (int n = min_n; n < max_n; n *= 4) {
+			benchmark->Args({n, set});
+		}
+		benchmark->Args({max_n, set});
+	}
+}
+
+// Minimize allocates a V^3 cube, which bounds the sizes we can run.
+void SolverSizes(benchmark::internal::Benchmark* benchmark) {
+	PointSets(benchmark, 16, 256);
+}
+
+void GraphSizes(benchmark::internal::Benchmark* benchmark) {
+	PointSets(benchmark, 16, 10000);
+}
+
+void BM_Minimize(benchmark::State& state) {
+	AdjacencyGraph input = Generator::EuclideanGraph(
+			Points(state.range(0), state.range(1), 1));
+	for (auto _ : state) {
+		N1Graph graph;
+		graph.Minimize(input);
+		benchmark::DoNotOptimize(graph.cost());
+	}
+	state.SetComplexityN(state.range(0));
+}
+BENCHMARK(BM_Minimize)->Apply(SolverSizes)->Unit(benchmark::kMillisecond);
+
+// The point-sets of SmallSolver, with the second argument switching it on,
+// against the general sweeps.
+void BM_MinimizeSmall(benchmark::State& state) {
+	AdjacencyGraph input = Generator::EuclideanGraph(
+			Points(state.range(0), UNIFORM, 1));
+	for (auto _ : state) {
+		N1Graph graph;
+		graph.set_small_solver(state.range(1) != 0);
+		graph.Minimize(input);
+		benchmark::DoNotOptimize(graph.cost());
+	}
+	state.SetComplexityN(state.range(0));
+}
+BENCHMARK(BM_MinimizeSmall)->ArgNames({"n", "small"})->ArgsProduct({
+		{8, 16, 32, 64}, {0, 1}})->Unit(benchmark::kMicrosecond);
+
+// The approximate mode with 16 candidates per step. The cost counter tells
+// how far it is from the exact mode.
+void BM_MinimizeNearest(benchmark::State& state) {
+	AdjacencyGraph input = Generator::EuclideanGraph(
+			Points(state.range(0), state.range(1), 1));
+	float cost = 0;
+	for (auto _ : state) {
+		N1Graph graph;
+		graph.set_candidates(16);
+		graph.Minimize(input);
+		cost = graph.cost();
+		benchmark::DoNotOptimize(cost);
+	}
+	state.counters["cost"] = cost;
+	state.SetComplexityN(state.range(0));
+}
+BENCHMARK(BM_MinimizeNearest)->Apply(SolverSizes)->Unit(
+		benchmark::kMillisecond);
+
+// The approximate mode followed by the local search, whose cost is to be
+// compared with the one of BM_MinimizeNearest.
+void BM_MinimizeRefined(benchmark::State& state) {
+	AdjacencyGraph input = Generator::EuclideanGraph(
+			Points(state.range(0), state.range(1), 1));
+	// A budget of one move per node, so that the work does not depend on
+	// how long the local search takes to converge.
+	int budget = state.range(0);
+	float cost = 0;
+	int moves = 0;
+	for (auto _ : state) {
+		N1Graph graph;
+		graph.set_candidates(16);
+		graph.Minimize(input);
+		moves = graph.Refine(input, budget, 0);
+		cost = graph.cost();
+		benchmark::DoNotOptimize(cost);
+	}
+	state.counters["cost"] = cost;
+	state.counters["moves"] = moves;
+	state.SetComplexityN(state.range(0));
+}
+BENCHMARK(BM_MinimizeRefined)->Apply(SolverSizes)->Unit(
+		benchmark::kMillisecond);
+
+// The hierarchical mode with leaves of 64 nodes, up to the sizes for which
+// only the graph is built.
+void BM_MinimizeHierarchical(benchmark::State& state) {
+	AdjacencyGraph input = Generator::EuclideanGraph(
+			Points(state.range(0), state.range(1), 1));
+	float cost = 0;
+	for (auto _ : state) {
+		N1Graph graph;
+		graph.MinimizeHierarchical(input, 64);
+		cost = graph.cost();
+		benchmark::DoNotOptimize(cost);
+	}
+	state.counters["cost"] = cost;
+	state.SetComplexityN(state.range(0));
+}
+BENCHMARK(BM_MinimizeHierarchical)->Apply(GraphSizes)->Unit(
+		benchmark::kMillisecond);
+
+void BM_EuclideanGraph(benchmark::State& state) {
+	std::vector<Vector<float> > points = Points(state.range(0),
+			state.range(1), 1);
+	for (auto _ : state) {
+		AdjacencyGraph input = Generator::EuclideanGraph(points);
+		benchmark::DoNotOptimize(input.NumberOfNodes());
+	}
+	state.SetComplexityN(state.range(0));
+}
+BENCHMARK(BM_EuclideanGraph)->Apply(GraphSizes)->Unit(
+		benchmark::kMillisecond);
+
+void BM_ReadCSV(benchmark::State& state) {
+	std::vector<Vector<float> > points = Points(state.range(0),
+			state.range(1), 1);
+	std::vector<std::string> lines;
+	for (const Vector<float>& point : points) {
+		lines.push_back(std::to_string(point[0]) + ","
+				+ std::to_string(point[1]));
+	}
+	std::string location = "n1graph_bench_" + std::to_string(state.range(0))
+			+ ".csv";
+	TextWriter::Write(location, lines);
+	for (auto _ : state) {
+		std::vector<Vector<float> > values = CSVReader::ReadCSV(location, ',');
+		benchmark::DoNotOptimize(values.size());
+	}
+	std::remove(location.c_str());
+	state.SetComplexityN(state.range(0));
+}
+BENCHMARK(BM_ReadCSV)->Apply(GraphSizes)->Unit(benchmark::kMicrosecond);
+
+void BM_Register(benchmark::State& state) {
+	N1Graph g1, g2;
+	g1.Minimize(Generator::EuclideanGraph(
+			Points(state.range(0), state.range(1), 1)));
+	g2.Minimize(Generator::EuclideanGraph(
+			Points(state.range(0), state.range(1), 2)));
+	for (auto _ : state) {
+		Matching matching;
+		matching.Register(g1, g2);
+		benchmark::DoNotOptimize(matching.Correspondence(0, 0));
+	}
+	state.SetComplexityN(state.range(0));
+}
+BENCHMARK(BM_Register)->Apply(SolverSizes)->Unit(benchmark::kMicrosecond);
+
+void BM_ToString(benchmark::State& state) {
+	N1Graph graph;
+	graph.Minimize(Generator::EuclideanGraph(
+			Points(state.range(0), state.range(1), 1)));
+	size_t bytes = 0;
+	for (auto _ : state) {
+		std::string text = graph.result().ToString();
+		bytes += text.size();
+	}
+	state.SetBytesProcessed(bytes);
+	state.SetComplexityN(state.range(0));
+}
+BENCHMARK(BM_ToString)->Apply(SolverSizes)->Unit(benchmark::kMicrosecond);
+
+void BM_ToTikz(benchmark::State& state) {
+	N1Graph g1, g2;
+	g1.Minimize(Generator::EuclideanGraph(
+			Points(state.range(0), state.range(1), 1)));
+	g2.Minimize(Generator::EuclideanGraph(
+			Points(state.range(0), state.range(1), 2)));
+	Matching matching;
+	matching.Register(g1, g2);
+	Vector<float> gap(25, 0);
+	size_t bytes = 0;
+	for (auto _ : state) {
+		std::string text = matching.ToTikz(g1, g2, gap, 1);
+		bytes += text.size();
+	}
+	state.SetBytesProcessed(bytes);
+	state.SetComplexityN(state.range(0));
+}
+BENCHMARK(BM_ToTikz)->Apply(SolverSizes)->Unit(benchmark::kMicrosecond);
+
+}  // namespace
+
+// Results are reported in JSON unless another format is requested, so that
+// runs of different versions can be compared.
+int main(int argc, char** argv) {
+	google::InitGoogleLogging(argv[0]);
+	std::vector<char*> arguments(argv, argv + argc);
+	bool has_format = false;
+	for (int i = 1; i < argc; ++i) {
+		has_format |= strncmp(argv[i], "--benchmark_format", 18) == 0;
+	}
+	char json_format[] = "--benchmark_format=json";
+	if (!has_format)
+		arguments.push_back(json_format);
+	int count = arguments.size();
+	benchmark::Initialize(&count, arguments.data());
+	if (benchmark::ReportUnrecognizedArguments(count, arguments.data()))
+		return 1;
+	benchmark::RunSpecifiedBenchmarks();
+	benchmark::Shutdown();
+	return 0;
+}
@@ -0,0 +1,129 @@
+/*
+ * Copyright 2014 Samuel de Sousa
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include <adjacency_graph.hpp>
+#include <executor.hpp>
+#include <generator.hpp>
+#include <local_search.hpp>
+#include <n1graph.hpp>
+
+using namespace n1graph;
+
+namespace {
+
+// Unit steps next to a far away point, whose distances absorb the steps in
+// float sums.
+AdjacencyGraph FarPoint() {
+	std::vector<Vector<float> > points;
+	for (int i = 0; i < 6; ++i)
+		points.push_back(Vector<float>(i, 0));
+	points.push_back(Vector<float>(1e7f, 0));
+	return Generator::EuclideanGraph(points);
+}
+
+}  // namespace
+
+TEST(N1GraphTest, PreciseCostKeepsTheWiderArithmetic) {
+	AdjacencyGraph input = FarPoint();
+	for (CostPrecision precision : { CostPrecision::DOUBLE_PRECISION,
+			CostPrecision::FIXED_POINT }) {
+		N1Graph graph;
+		graph.set_precision(precision);
+		graph.Minimize(input);
+		double expected = N1Graph::EvaluatePrecise(input, graph.nodes());
+		EXPECT_NEAR(graph.precise_cost(), expected, 1e-9 * expected);
+		EXPECT_NE(graph.precise_cost(),
+				static_cast<double>(N1Graph::Evaluate(input, graph.nodes())));
+	}
+}
+
+TEST(N1GraphTest, ParallelSweepsMatchTheCube) {
+	// Long enough for the automatic plan to spread the sweeps.
+	const int n = 100;
+	std::vector<Vector<float> > uniform = Generator::Uniform(n, 100.f, 45);
+	// Each point twice, whose sweeps tie with the ones of its twin in
+	// another chunk, thus the first start must win the merge.
+	std::vector<Vector<float> > twins(uniform.begin(), uniform.begin() + n / 2);
+	twins.insert(twins.end(), uniform.begin(), uniform.begin() + n / 2);
+	ThreadPool pool(4);
+	for (const std::vector<Vector<float> >& points : { uniform, twins }) {
+		AdjacencyGraph input = Generator::EuclideanGraph(points);
+		N1Graph cube;
+		cube.set_strategy(SolverStrategy::CUBE);
+		cube.Minimize(input);
+		N1Graph parallel;
+		parallel.set_executor(&pool);
+		parallel.set_strategy(SolverStrategy::AUTO);
+		parallel.Minimize(input);
+		ASSERT_GT(parallel.plan().threads_, 1);
+		EXPECT_EQ(parallel.plan().strategy_, SolverStrategy::ROLLING);
+		EXPECT_EQ(parallel.nodes(), cube.nodes());
+		EXPECT_EQ(parallel.cost(), cube.cost());
+	}
+}
+
+TEST(N1GraphTest, AutomaticPlanRunsTheRollingSweeps) {
+	ThreadPool pool(4);
+	N1Graph graph;
+	graph.set_executor(&pool);
+	graph.set_strategy(SolverStrategy::AUTO);
+	// Serial, without a budget.
+	SolverPlan plan = graph.Explain(20);
+	EXPECT_EQ(plan.threads_, 1);
+	EXPECT_EQ(plan.strategy_, SolverStrategy::ROLLING);
+	EXPECT_EQ(plan.estimated_bytes_,
+			N1Graph::EstimateMemory(20, SolverStrategy::ROLLING, false));
+	// The wider precisions keep the workspace of the other threads.
+	const int n = 500;
+	graph.set_precision(CostPrecision::FIXED_POINT);
+	plan = graph.Explain(n);
+	ASSERT_EQ(plan.threads_, 4);
+	EXPECT_EQ(plan.estimated_bytes_,
+			N1Graph::EstimateMemory(n, SolverStrategy::ROLLING, false)
+					+ 3 * 2 * n * sizeof(int) + n * n * sizeof(int64_t));
+}
+
+TEST(LocalSearchTest, IncrementalCostMatchesEvaluation) {
+	std::mt19937 engine(44);
+	for (int trial = 0; trial < 20; ++trial) {
+		int n = 5 + engine() % 20;
+		AdjacencyGraph input = Generator::EuclideanGraph(
+				Generator::Uniform(n, 100.f, engine()));
+		std::vector<int> nodes(n);
+		for (int i = 0; i < n; ++i)
+			nodes[i] = i;
+		std::shuffle(nodes.begin(), nodes.end(), engine);
+		// One move per run, each checked against a full evaluation.
+		LocalSearch search(input.adjacency(), nodes);
+		while (search.Run(1, 0) == 1) {
+			std::vector<int> sorted = search.nodes();
+			std::sort(sorted.begin(), sorted.end());
+			for (int i = 0; i < n; ++i)
+				ASSERT_EQ(sorted[i], i);
+			double expected = N1Graph::EvaluatePrecise(input, search.nodes());
+			ASSERT_NEAR(search.cost(), expected, 1e-9 * expected);
+			ASSERT_NEAR(search.cost(), N1Graph::Evaluate(input, search.nodes()),
+					1e-5 * expected);
+		}
+	}
+}
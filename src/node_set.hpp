@@ -0,0 +1,95 @@
+/*
+ * Copyright 2014 Samuel de Sousa
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef NODE_SET_HPP_
+#define NODE_SET_HPP_
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace n1graph {
+
+/**
+ * A set of nodes packed into 64-bit words. The members and the non-members
+ * are visited in increasing order word by word, skipping the set bits with
+ * count-trailing-zeros, so that a full word of members costs a single test
+ * when the non-members are scanned. The methods are inlined, since they are
+ * called in the innermost loops of the sweeps.
+ */
+class NodeSet {
+public:
+	explicit NodeSet(int n) :
+			n_(n), words_((n + 63) / 64, 0) {
+	}
+
+	/**
+	 * Removes all the nodes.
+	 *
+	 * Time Complexity: O(V / 64)
+	 */
+	void Clear() {
+		std::fill(words_.begin(), words_.end(), 0);
+	}
+
+	void Insert(int node) {
+		words_[node >> 6] |= uint64_t(1) << (node & 63);
+	}
+
+	bool Contains(int node) const {
+		return (words_[node >> 6] >> (node & 63)) & 1;
+	}
+
+	/**
+	 * Calls visit on every member in increasing order.
+	 *
+	 * Time Complexity: O(V / 64 + members)
+	 */
+	template<typename Visitor>
+	void ForEach(Visitor visit) const {
+		for (int w = 0; w < static_cast<int>(words_.size()); ++w) {
+			for (uint64_t word = words_[w]; word != 0; word &= word - 1) {
+				visit((w << 6) + __builtin_ctzll(word));
+			}
+		}
+	}
+
+	/**
+	 * Calls visit on every non-member in increasing order.
+	 *
+	 * Time Complexity: O(V / 64 + non-members)
+	 */
+	template<typename Visitor>
+	void ForEachMissing(Visitor visit) const {
+		for (int w = 0; w < static_cast<int>(words_.size()); ++w) {
+			uint64_t word = ~words_[w];
+			// The bits past the last node are not nodes.
+			if ((w + 1) << 6 > n_)
+				word &= (uint64_t(1) << (n_ & 63)) - 1;
+			for (; word != 0; word &= word - 1) {
+				visit((w << 6) + __builtin_ctzll(word));
+			}
+		}
+	}
+
+private:
+	int n_;
+	std::vector<uint64_t> words_;
+};
+
+} /* namespace n1graph */
+#endif /* NODE_SET_HPP_ */
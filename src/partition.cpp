@@ -0,0 +1,126 @@
+/*
+ * Copyright 2014 Samuel de Sousa
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <partition.hpp>
+
+#include <algorithm>
+#include <limits>
+
+#include <glog/logging.h>
+
+namespace n1graph {
+
+const int Partition::kBranching;
+
+std::vector<std::vector<int> > Partition::Leaves(
+		const Matrix<float>& distances, int leaf_size) {
+	CHECK_GE(leaf_size, 2);
+	int n = distances.rows();
+	std::vector<int> nodes(n);
+	for (int i = 0; i < n; ++i) {
+		nodes[i] = i;
+	}
+	std::vector<std::vector<int> > leaves;
+	Split(distances, nodes, leaf_size, &leaves);
+	return leaves;
+}
+
+void Partition::Split(const Matrix<float>& distances,
+		const std::vector<int>& nodes, int leaf_size,
+		std::vector<std::vector<int> >* leaves) {
+	int n = nodes.size();
+	if (n <= leaf_size) {
+		leaves->push_back(nodes);
+		return;
+	}
+	int count = std::min(kBranching, (n + leaf_size - 1) / leaf_size);
+	// Farthest-point sampling of the centres, from the first node.
+	std::vector<int> centres(1, nodes[0]);
+	std::vector<float> nearest(n);
+	std::vector<int> cluster(n, 0);
+	for (int i = 0; i < n; ++i) {
+		nearest[i] = distances(nodes[i], centres[0]);
+	}
+	while (static_cast<int>(centres.size()) < count) {
+		int farthest = std::max_element(nearest.begin(), nearest.end())
+				- nearest.begin();
+		if (nearest[farthest] == 0)
+			break;
+		centres.push_back(nodes[farthest]);
+		for (int i = 0; i < n; ++i) {
+			float distance = distances(nodes[i], centres.back());
+			if (distance < nearest[i]) {
+				nearest[i] = distance;
+				cluster[i] = centres.size() - 1;
+			}
+		}
+	}
+	count = centres.size();
+	std::vector<std::vector<int> > clusters(count);
+	for (int i = 0; i < n; ++i) {
+		clusters[cluster[i]].push_back(nodes[i]);
+	}
+	// The chain visits the nearest unvisited centre next.
+	std::vector<int> order(1, 0);
+	std::vector<bool> visited(count, false);
+	visited[0] = true;
+	while (static_cast<int>(order.size()) < count) {
+		int latest = centres[order.back()];
+		int next = -1;
+		for (int c = 0; c < count; ++c) {
+			if (!visited[c] && (next < 0 || distances(latest, centres[c])
+					< distances(latest, centres[next])))
+				next = c;
+		}
+		visited[next] = true;
+		order.push_back(next);
+	}
+	// An odd cluster hands its node nearest to the next centre over.
+	for (int k = 0; k + 1 < count; ++k) {
+		std::vector<int>& current = clusters[order[k]];
+		if (current.size() % 2 == 0)
+			continue;
+		int next_centre = centres[order[k + 1]];
+		int size = current.size();
+		int closest = 0;
+		for (int i = 1; i < size; ++i) {
+			if (distances(current[i], next_centre)
+					< distances(current[closest], next_centre))
+				closest = i;
+		}
+		clusters[order[k + 1]].push_back(current[closest]);
+		current.erase(current.begin() + closest);
+	}
+	// Coincident points may leave a single cluster, which is cut in chunks.
+	for (const std::vector<int>& current : clusters) {
+		if (static_cast<int>(current.size()) == n) {
+			int step = leaf_size / 2 * 2;
+			for (int begin = 0; begin < n; begin += step) {
+				leaves->push_back(
+						std::vector<int>(nodes.begin() + begin,
+								nodes.begin() + std::min(n, begin + step)));
+			}
+			return;
+		}
+	}
+	for (int c : order) {
+		if (!clusters[c].empty())
+			Split(distances, clusters[c], leaf_size, leaves);
+	}
+}
+
+} /* namespace n1graph */
@@ -0,0 +1,65 @@
+/*
+ * Copyright 2014 Samuel de Sousa
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef PARTITION_HPP_
+#define PARTITION_HPP_
+
+#include <vector>
+
+#include <matrix.hpp>
+
+namespace n1graph {
+
+/**
+ * Splits a point-set into spatially coherent leaves, using only the distances
+ * between the points. Each level picks up to kBranching centres by
+ * farthest-point sampling, assigns every node to its nearest centre and
+ * recurses into the clusters larger than the leaf size.
+ */
+class Partition {
+private:
+	Partition() {
+	}
+public:
+	/**
+	 * The maximum number of clusters per level.
+	 */
+	static const int kBranching = 8;
+
+	/**
+	 * Returns the leaves ordered along a nearest-centre chain, so that
+	 * consecutive leaves are close to each other. Every leaf but the last one
+	 * has an even number of nodes, so that each leaf starts at an even
+	 * position once the leaves are concatenated, i.e. its join/isolate roles
+	 * are kept.
+	 *
+	 * Time Complexity: O(V * kBranching * log(V / leaf_size)).
+	 *
+	 * @param distances: The adjacency matrix of the complete graph.
+	 * @param leaf_size: The maximum number of nodes per leaf, at least 2.
+	 */
+	static std::vector<std::vector<int> > Leaves(
+			const Matrix<float>& distances, int leaf_size);
+
+private:
+	static void Split(const Matrix<float>& distances,
+			const std::vector<int>& nodes, int leaf_size,
+			std::vector<std::vector<int> >* leaves);
+};
+
+} /* namespace n1graph */
+#endif /* PARTITION_HPP_ */
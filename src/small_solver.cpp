@@ -0,0 +1,93 @@
+/*
+ * Copyright 2014 Samuel de Sousa
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <small_solver.hpp>
+
+#include <array>
+#include <cstdint>
+#include <limits>
+
+#include <glog/logging.h>
+
+namespace n1graph {
+
+template<int N>
+float SmallSolver<N>::Minimize(const Matrix<float>& distances,
+		std::vector<int>* nodes) {
+	int n = distances.rows();
+	CHECK_LE(n, N);
+	std::array<float, N * N> distance;
+	for (int i = 0; i < n; ++i) {
+		for (int j = 0; j < n; ++j) {
+			distance[i * N + j] = distances(i, j);
+		}
+	}
+	// The sum over the used nodes in increasing order, like JoinGraph.
+	auto join = [&distance](int node, uint64_t used) {
+		const float* row = &distance[node * N];
+		float cost = 0;
+		while (used != 0) {
+			cost += row[__builtin_ctzll(used)];
+			used &= used - 1;
+		}
+		return cost;
+	};
+	uint64_t all = n == 64 ? ~uint64_t(0) : (uint64_t(1) << n) - 1;
+	std::array<int, N> best;
+	float best_cost = std::numeric_limits<float>::max();
+	std::array<int, N> sequence;
+	for (int initial_node = 0; initial_node < n; ++initial_node) {
+		sequence[0] = initial_node;
+		uint64_t used = uint64_t(1) << initial_node;
+		float cost = 0;
+		bool join_graph = false;
+		int k = 1;
+		for (; k < n && cost < best_cost; ++k) {
+			int latest_node = sequence[k - 1];
+			int candidate = -1;
+			float candidate_cost = 0;
+			for (uint64_t free = ~used & all; free != 0; free &= free - 1) {
+				int j = __builtin_ctzll(free);
+				float new_cost = cost
+						+ (join_graph ?
+								join(j, used) : distance[j * N + latest_node]);
+				if (candidate < 0 || new_cost < candidate_cost) {
+					candidate = j;
+					candidate_cost = new_cost;
+				}
+			}
+			cost = candidate_cost;
+			sequence[k] = candidate;
+			used |= uint64_t(1) << candidate;
+			join_graph = !join_graph;
+		}
+		// The first initial node with the strictly lowest cost wins.
+		if (k == n && cost < best_cost) {
+			best_cost = cost;
+			best = sequence;
+		}
+	}
+	nodes->assign(best.begin(), best.begin() + n);
+	return best_cost;
+}
+
+template class SmallSolver<8> ;
+template class SmallSolver<16> ;
+template class SmallSolver<32> ;
+template class SmallSolver<64> ;
+
+} /* namespace n1graph */
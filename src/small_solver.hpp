@@ -0,0 +1,56 @@
+/*
+ * Copyright 2014 Samuel de Sousa
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef SMALL_SOLVER_HPP_
+#define SMALL_SOLVER_HPP_
+
+#include <vector>
+
+#include <matrix.hpp>
+
+namespace n1graph {
+
+/**
+ * The sweeps of N1Graph::Minimize for point-sets of at most N nodes, with all
+ * the state on the stack: the distances in a std::array with a row stride of
+ * N and the used nodes in a 64-bit mask, walked in increasing order so that
+ * every cost is accumulated exactly as in the other strategies. It is
+ * instantiated for N = 8, 16, 32 and 64.
+ */
+template<int N>
+class SmallSolver {
+	static_assert(N <= 64, "The used nodes are kept in a 64-bit mask.");
+private:
+	SmallSolver() {
+	}
+public:
+	/**
+	 * Sweeps every initial node, pruning the sweeps which reach the best one.
+	 *
+	 * Time Complexity: O(V^4) distance reads, as Minimize.
+	 * Space Complexity: O(N^2) on the stack.
+	 *
+	 * @param distances: The adjacency matrix of at most N nodes.
+	 * @param nodes: Filled with the join/isolate sequence found.
+	 * @return its cost.
+	 */
+	static float Minimize(const Matrix<float>& distances,
+			std::vector<int>* nodes);
+};
+
+} /* namespace n1graph */
+#endif /* SMALL_SOLVER_HPP_ */
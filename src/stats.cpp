@@ -0,0 +1,132 @@
+/*
+ * Copyright 2014 Samuel de Sousa
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <stats.hpp>
+
+#include <text_writer.hpp>
+
+namespace n1graph {
+
+std::atomic<bool> Stats::enabled_(false);
+std::atomic<int64_t> Stats::nanoseconds_[NUMBER_OF_PHASES];
+std::atomic<int64_t> Stats::calls_[NUMBER_OF_PHASES];
+std::atomic<int64_t> Stats::counters_[NUMBER_OF_COUNTERS];
+
+const char* Stats::Name(StatsPhase phase) {
+	switch (phase) {
+	case READ_CSV:
+		return "read_csv";
+	case BUILD_INPUT:
+		return "build_input";
+	case MINIMIZE:
+		return "minimize";
+	case MINIMIZE_SWEEP:
+		return "minimize_sweep";
+	case MINIMIZE_LAYER:
+		return "minimize_layer";
+	case BUILD_GRAPH:
+		return "build_graph";
+	case REFINE:
+		return "refine";
+	case REGISTER:
+		return "register";
+	case SERIALIZE:
+		return "serialize";
+	default:
+		return "unknown";
+	}
+}
+
+const char* Stats::Name(StatsCounter counter) {
+	switch (counter) {
+	case CANDIDATES_EVALUATED:
+		return "candidates_evaluated";
+	case SWEEPS_PRUNED:
+		return "sweeps_pruned";
+	case MOVES_APPLIED:
+		return "moves_applied";
+	case BYTES_READ:
+		return "bytes_read";
+	case BYTES_WRITTEN:
+		return "bytes_written";
+	default:
+		return "unknown";
+	}
+}
+
+void Stats::Reset() {
+	for (int p = 0; p < NUMBER_OF_PHASES; ++p) {
+		nanoseconds_[p].store(0);
+		calls_[p].store(0);
+	}
+	for (int c = 0; c < NUMBER_OF_COUNTERS; ++c) {
+		counters_[c].store(0);
+	}
+}
+
+std::string Stats::ToJson() {
+	std::string output = "{\n  \"timers\": {\n";
+	for (int p = 0; p < NUMBER_OF_PHASES; ++p) {
+		StatsPhase phase = static_cast<StatsPhase>(p);
+		output += "    \"" + std::string(Name(phase)) + "\": {\"calls\": "
+				+ std::to_string(calls(phase)) + ", \"seconds\": "
+				+ std::to_string(nanoseconds(phase) * 1e-9) + "}";
+		output += p + 1 < NUMBER_OF_PHASES ? ",\n" : "\n";
+	}
+	output += "  },\n  \"counters\": {\n";
+	for (int c = 0; c < NUMBER_OF_COUNTERS; ++c) {
+		StatsCounter stats_counter = static_cast<StatsCounter>(c);
+		output += "    \"" + std::string(Name(stats_counter)) + "\": "
+				+ std::to_string(counter(stats_counter));
+		output += c + 1 < NUMBER_OF_COUNTERS ? ",\n" : "\n";
+	}
+	output += "  }\n}\n";
+	return output;
+}
+
+std::string Stats::ToPrometheus() {
+	std::string output;
+	output += "# TYPE n1graph_phase_seconds_total counter\n";
+	for (int p = 0; p < NUMBER_OF_PHASES; ++p) {
+		StatsPhase phase = static_cast<StatsPhase>(p);
+		output += "n1graph_phase_seconds_total{phase=\""
+				+ std::string(Name(phase)) + "\"} "
+				+ std::to_string(nanoseconds(phase) * 1e-9) + "\n";
+	}
+	output += "# TYPE n1graph_phase_calls_total counter\n";
+	for (int p = 0; p < NUMBER_OF_PHASES; ++p) {
+		StatsPhase phase = static_cast<StatsPhase>(p);
+		output += "n1graph_phase_calls_total{phase=\""
+				+ std::string(Name(phase)) + "\"} "
+				+ std::to_string(calls(phase)) + "\n";
+	}
+	for (int c = 0; c < NUMBER_OF_COUNTERS; ++c) {
+		StatsCounter stats_counter = static_cast<StatsCounter>(c);
+		std::string name = "n1graph_" + std::string(Name(stats_counter))
+				+ "_total";
+		output += "# TYPE " + name + " counter\n";
+		output += name + " " + std::to_string(counter(stats_counter)) + "\n";
+	}
+	return output;
+}
+
+void Stats::Write(const std::string& location, StatsFormat format) {
+	TextWriter::Write(location,
+			format == StatsFormat::PROMETHEUS ? ToPrometheus() : ToJson());
+}
+
+} /* namespace n1graph */
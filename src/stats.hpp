@@ -0,0 +1,171 @@
+/*
+ * Copyright 2014 Samuel de Sousa
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef STATS_HPP_
+#define STATS_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace n1graph {
+
+/**
+ * The phases measured by ScopedTimer.
+ */
+enum StatsPhase {
+	READ_CSV,
+	BUILD_INPUT,
+	MINIMIZE,
+	// One sweep of Minimize, i.e. one initial node.
+	MINIMIZE_SWEEP,
+	// One step of a sweep, i.e. one node added to the sequence.
+	MINIMIZE_LAYER,
+	BUILD_GRAPH,
+	// The local search of N1Graph::Refine.
+	REFINE,
+	REGISTER,
+	SERIALIZE,
+	NUMBER_OF_PHASES
+};
+
+/**
+ * The counters incremented through Stats::Increment.
+ */
+enum StatsCounter {
+	// Candidate nodes whose cost was computed by a sweep.
+	CANDIDATES_EVALUATED,
+	// Sweeps abandoned because they reached the incumbent.
+	SWEEPS_PRUNED,
+	// Moves applied by N1Graph::Refine.
+	MOVES_APPLIED,
+	BYTES_READ,
+	BYTES_WRITTEN,
+	NUMBER_OF_COUNTERS
+};
+
+enum StatsFormat {
+	JSON,
+	PROMETHEUS
+};
+
+/**
+ * Process-wide timers and counters of the library. They are disabled by
+ * default, in which case each probe costs a relaxed atomic load. Building
+ * with N1GRAPH_NO_STATS removes them altogether.
+ */
+class Stats {
+private:
+	Stats() {
+	}
+public:
+	static void Enable(bool enabled) {
+		enabled_.store(enabled, std::memory_order_relaxed);
+	}
+
+	static bool enabled() {
+#ifdef N1GRAPH_NO_STATS
+		return false;
+#else
+		return enabled_.load(std::memory_order_relaxed);
+#endif
+	}
+
+	static void AddTime(StatsPhase phase, int64_t nanoseconds) {
+		nanoseconds_[phase].fetch_add(nanoseconds, std::memory_order_relaxed);
+		calls_[phase].fetch_add(1, std::memory_order_relaxed);
+	}
+
+	static void Increment(StatsCounter counter, int64_t value = 1) {
+		if (enabled())
+			counters_[counter].fetch_add(value, std::memory_order_relaxed);
+	}
+
+	static int64_t nanoseconds(StatsPhase phase) {
+		return nanoseconds_[phase].load(std::memory_order_relaxed);
+	}
+
+	static int64_t calls(StatsPhase phase) {
+		return calls_[phase].load(std::memory_order_relaxed);
+	}
+
+	static int64_t counter(StatsCounter counter) {
+		return counters_[counter].load(std::memory_order_relaxed);
+	}
+
+	/**
+	 * Sets all timers and counters to zero.
+	 */
+	static void Reset();
+
+	/**
+	 * Returns all timers and counters as a JSON object.
+	 */
+	static std::string ToJson();
+
+	/**
+	 * Returns all timers and counters in the Prometheus text format.
+	 */
+	static std::string ToPrometheus();
+
+	/**
+	 * Writes all timers and counters into a file.
+	 *
+	 * @param location the output file location.
+	 * @param format the format of the file.
+	 */
+	static void Write(const std::string& location, StatsFormat format);
+
+	static const char* Name(StatsPhase phase);
+	static const char* Name(StatsCounter counter);
+
+private:
+	static std::atomic<bool> enabled_;
+	static std::atomic<int64_t> nanoseconds_[NUMBER_OF_PHASES];
+	static std::atomic<int64_t> calls_[NUMBER_OF_PHASES];
+	static std::atomic<int64_t> counters_[NUMBER_OF_COUNTERS];
+};
+
+/**
+ * Adds the time spent in its scope to a phase.
+ */
+class ScopedTimer {
+public:
+	explicit ScopedTimer(StatsPhase phase) :
+			phase_(phase), active_(Stats::enabled()) {
+		if (active_)
+			start_ = std::chrono::steady_clock::now();
+	}
+
+	~ScopedTimer() {
+		if (active_) {
+			std::chrono::steady_clock::duration elapsed =
+					std::chrono::steady_clock::now() - start_;
+			Stats::AddTime(phase_, std::chrono::duration_cast<
+					std::chrono::nanoseconds>(elapsed).count());
+		}
+	}
+
+private:
+	StatsPhase phase_;
+	bool active_;
+	std::chrono::steady_clock::time_point start_;
+};
+
+} /* namespace n1graph */
+#endif /* STATS_HPP_ */
@@ -17,23 +17,38 @@
 
 #include <text_writer.hpp>
 
+#include <glog/logging.h>
+
+#include <stats.hpp>
+#include <tracer.hpp>
+
 namespace n1graph {
 
 void TextWriter::Write(std::string location, const std::string& text) {
+	ScopedTimer timer(StatsPhase::SERIALIZE);
+	ScopedTrace trace(StatsPhase::SERIALIZE);
 	std::ofstream output_file;
 	output_file.open(location.c_str());
 	output_file << text;
 	output_file.close();
+	CHECK(output_file) << "Could not write " << location;
+	Stats::Increment(StatsCounter::BYTES_WRITTEN, text.size());
 }
 
 void TextWriter::Write(std::string location,
 		const std::vector<std::string>& lines) {
+	ScopedTimer timer(StatsPhase::SERIALIZE);
+	ScopedTrace trace(StatsPhase::SERIALIZE);
 	std::ofstream output_file;
 	output_file.open(location.c_str());
+	int64_t bytes = 0;
 	for (const std::string& line : lines) {
 		output_file << line << std::endl;
+		bytes += line.size() + 1;
 	}
 	output_file.close();
+	CHECK(output_file) << "Could not write " << location;
+	Stats::Increment(StatsCounter::BYTES_WRITTEN, bytes);
 }
 
 } // namespace n1graph
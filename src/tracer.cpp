@@ -0,0 +1,187 @@
+/*
+ * Copyright 2014 Samuel de Sousa
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <tracer.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <memory.hpp>
+#include <text_writer.hpp>
+
+namespace n1graph {
+
+namespace {
+
+struct TraceEvent {
+	int64_t timestamp;
+	int64_t argument;
+	StatsPhase phase;
+	bool begin;
+};
+
+/**
+ * The ring buffer of one thread. Only the owner thread writes into it, the
+ * number of recorded events is published with release semantics. It doubles
+ * while it fills, and only wraps around at Tracer::kBufferSize events.
+ */
+struct TraceBuffer {
+	int thread_id;
+	std::atomic<uint64_t> recorded;
+	// Whether the owner thread has exited.
+	bool retired;
+	uint64_t capacity;
+	std::unique_ptr<TraceEvent[]> events;
+	std::unique_ptr<ScopedAllocation> allocation;
+
+	explicit TraceBuffer(int id) :
+			thread_id(id), recorded(0), retired(false), capacity(0) {
+		Grow();
+	}
+
+	// Doubles the capacity, keeping the events of the full buffer.
+	void Grow() {
+		uint64_t grown_capacity = std::min<uint64_t>(
+				std::max<uint64_t>(2 * capacity, Tracer::kInitialBufferSize),
+				Tracer::kBufferSize);
+		std::unique_ptr<TraceEvent[]> grown(new TraceEvent[grown_capacity]);
+		std::copy(events.get(), events.get() + capacity, grown.get());
+		events.swap(grown);
+		allocation.reset(new ScopedAllocation(MemorySubsystem::TRACER,
+				grown_capacity * sizeof(TraceEvent)));
+		capacity = grown_capacity;
+	}
+};
+
+std::mutex buffers_mutex;
+// The buffers outlive their threads so that their events can still be dumped,
+// until Clear discards them.
+std::vector<std::unique_ptr<TraceBuffer> > buffers;
+int next_thread_id = 0;
+
+/**
+ * Retires the buffer of a thread when the thread exits. A buffer without
+ * events is released at once.
+ */
+struct BufferOwner {
+	TraceBuffer* buffer = nullptr;
+
+	~BufferOwner() {
+		if (buffer == nullptr)
+			return;
+		std::lock_guard<std::mutex> lock(buffers_mutex);
+		if (buffer->recorded.load(std::memory_order_acquire) > 0) {
+			buffer->retired = true;
+			return;
+		}
+		buffers.erase(std::find_if(buffers.begin(), buffers.end(),
+				[this](const std::unique_ptr<TraceBuffer>& owned) {
+					return owned.get() == buffer;
+				}));
+	}
+};
+
+const std::chrono::steady_clock::time_point epoch =
+		std::chrono::steady_clock::now();
+
+TraceBuffer* ThreadBuffer() {
+	thread_local BufferOwner owner;
+	if (owner.buffer == nullptr) {
+		std::lock_guard<std::mutex> lock(buffers_mutex);
+		buffers.emplace_back(new TraceBuffer(next_thread_id++));
+		owner.buffer = buffers.back().get();
+	}
+	return owner.buffer;
+}
+
+void Record(StatsPhase phase, int64_t argument, bool begin) {
+	TraceBuffer* buffer = ThreadBuffer();
+	uint64_t index = buffer->recorded.load(std::memory_order_relaxed);
+	if (index == buffer->capacity && index < Tracer::kBufferSize)
+		buffer->Grow();
+	TraceEvent& event = buffer->events[index % buffer->capacity];
+	event.timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now() - epoch).count();
+	event.argument = argument;
+	event.phase = phase;
+	event.begin = begin;
+	buffer->recorded.store(index + 1, std::memory_order_release);
+}
+
+}  // namespace
+
+std::atomic<bool> Tracer::enabled_(false);
+
+void Tracer::Begin(StatsPhase phase, int64_t argument) {
+	Record(phase, argument, true);
+}
+
+void Tracer::End(StatsPhase phase) {
+	Record(phase, -1, false);
+}
+
+std::string Tracer::ToJson() {
+	std::lock_guard<std::mutex> lock(buffers_mutex);
+	std::string output = "{\"traceEvents\":[\n";
+	bool first = true;
+	for (const std::unique_ptr<TraceBuffer>& buffer : buffers) {
+		uint64_t recorded = buffer->recorded.load(std::memory_order_acquire);
+		uint64_t oldest = recorded > kBufferSize ? recorded - kBufferSize : 0;
+		// The end events whose begin was overwritten are dropped.
+		int depth = 0;
+		for (uint64_t i = oldest; i < recorded; ++i) {
+			const TraceEvent& event = buffer->events[i % buffer->capacity];
+			if (!event.begin && depth == 0)
+				continue;
+			depth += event.begin ? 1 : -1;
+			if (!first)
+				output += ",\n";
+			first = false;
+			output += "{\"name\":\"" + std::string(Stats::Name(event.phase))
+					+ "\",\"ph\":\"" + (event.begin ? "B" : "E")
+					+ "\",\"ts\":" + std::to_string(event.timestamp / 1000.0)
+					+ ",\"pid\":1,\"tid\":"
+					+ std::to_string(buffer->thread_id);
+			if (event.argument >= 0)
+				output += ",\"args\":{\"node\":"
+						+ std::to_string(event.argument) + "}";
+			output += "}";
+		}
+	}
+	output += "\n]}\n";
+	return output;
+}
+
+void Tracer::Write(const std::string& location) {
+	TextWriter::Write(location, ToJson());
+}
+
+void Tracer::Clear() {
+	std::lock_guard<std::mutex> lock(buffers_mutex);
+	buffers.erase(std::remove_if(buffers.begin(), buffers.end(),
+			[](const std::unique_ptr<TraceBuffer>& buffer) {
+				return buffer->retired;
+			}), buffers.end());
+	for (const std::unique_ptr<TraceBuffer>& buffer : buffers) {
+		buffer->recorded.store(0, std::memory_order_release);
+	}
+}
+
+} /* namespace n1graph */
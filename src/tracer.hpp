@@ -0,0 +1,116 @@
+/*
+ * Copyright 2014 Samuel de Sousa
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef TRACER_HPP_
+#define TRACER_HPP_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include <stats.hpp>
+
+namespace n1graph {
+
+/**
+ * An opt-in timeline of the library in the Chrome trace-event format, which
+ * can be loaded in chrome://tracing or Perfetto. Each thread records its
+ * begin/end events into its own ring buffer without locking, the oldest
+ * events are overwritten once the buffer is full.
+ */
+class Tracer {
+private:
+	Tracer() {
+	}
+public:
+	// The number of events kept per thread. The buffer of a thread starts
+	// with kInitialBufferSize events and doubles as it fills, up to about
+	// 1.5 MB at 24 bytes per event.
+	static const int kBufferSize = 1 << 16;
+	static const int kInitialBufferSize = 1 << 10;
+
+	static void Enable(bool enabled) {
+		enabled_.store(enabled, std::memory_order_relaxed);
+	}
+
+	static bool enabled() {
+		return enabled_.load(std::memory_order_relaxed);
+	}
+
+	/**
+	 * Records the beginning of a phase in the calling thread.
+	 *
+	 * @param phase: The phase, named after Stats::Name.
+	 * @param argument: An optional argument such as the initial node of a
+	 * sweep, ignored when negative.
+	 */
+	static void Begin(StatsPhase phase, int64_t argument = -1);
+
+	/**
+	 * Records the end of a phase in the calling thread.
+	 */
+	static void End(StatsPhase phase);
+
+	/**
+	 * Returns the events of all threads in the Chrome trace-event JSON
+	 * format. It should be called while no traced work is running.
+	 */
+	static std::string ToJson();
+
+	/**
+	 * Writes the events of all threads into a file.
+	 *
+	 * @param location the output file location.
+	 */
+	static void Write(const std::string& location);
+
+	/**
+	 * Discards the events of all threads, and releases the buffers of the
+	 * threads which have exited. The buffer of a thread which exits without
+	 * events is released at once. The buffers are accounted in Memory as
+	 * MemorySubsystem::TRACER. As ToJson, it must not be called while traced
+	 * work is running, whose events could otherwise survive it.
+	 */
+	static void Clear();
+
+private:
+	static std::atomic<bool> enabled_;
+};
+
+/**
+ * Records the begin and end events of its scope.
+ */
+class ScopedTrace {
+public:
+	explicit ScopedTrace(StatsPhase phase, int64_t argument = -1) :
+			phase_(phase), active_(Tracer::enabled()) {
+		if (active_)
+			Tracer::Begin(phase, argument);
+	}
+
+	~ScopedTrace() {
+		if (active_)
+			Tracer::End(phase_);
+	}
+
+private:
+	StatsPhase phase_;
+	bool active_;
+};
+
+} /* namespace n1graph */
+#endif /* TRACER_HPP_ */
@@ -0,0 +1,78 @@
+/*
+ * Copyright 2014 Samuel de Sousa
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "gtest/gtest.h"
+
+#include <string>
+#include <thread>
+
+#include <memory.hpp>
+#include <tracer.hpp>
+
+using namespace n1graph;
+
+namespace {
+
+int Count(const std::string& text, const std::string& pattern) {
+	int count = 0;
+	for (size_t at = text.find(pattern); at != std::string::npos;
+			at = text.find(pattern, at + 1))
+		count++;
+	return count;
+}
+
+}  // namespace
+
+TEST(TracerTest, ReleasesTheBuffersOfExitedThreads) {
+	Memory::Enable(true);
+	Tracer::Enable(true);
+	int64_t before = Memory::current(MemorySubsystem::TRACER);
+	std::thread traced([]() {
+		ScopedTrace trace(StatsPhase::MINIMIZE);
+	});
+	traced.join();
+	// The events of the exited thread can still be dumped, from a buffer
+	// which has not grown to the full ring.
+	EXPECT_GT(Memory::current(MemorySubsystem::TRACER), before);
+	// The events take 24 bytes.
+	EXPECT_EQ(Memory::current(MemorySubsystem::TRACER) - before,
+			Tracer::kInitialBufferSize * 24);
+	EXPECT_NE(Tracer::ToJson().find("\"ph\":\"B\""), std::string::npos);
+	Tracer::Clear();
+	EXPECT_EQ(Memory::current(MemorySubsystem::TRACER), before);
+	Tracer::Enable(false);
+	Memory::Enable(false);
+}
+
+TEST(TracerTest, DropsTheEndsOfOverwrittenBegins) {
+	Tracer::Clear();
+	Tracer::Enable(true);
+	std::thread traced([]() {
+		// The begin of the outer phase and of the first sweep wrap around.
+		ScopedTrace trace(StatsPhase::MINIMIZE);
+		for (int i = 0; i < Tracer::kBufferSize / 2; ++i) {
+			ScopedTrace sweep_trace(StatsPhase::MINIMIZE_SWEEP, i);
+		}
+	});
+	traced.join();
+	std::string json = Tracer::ToJson();
+	EXPECT_EQ(Count(json, "\"ph\":\"B\""), Tracer::kBufferSize / 2 - 1);
+	EXPECT_EQ(Count(json, "\"ph\":\"E\""), Tracer::kBufferSize / 2 - 1);
+	EXPECT_LT(json.find("\"ph\":\"B\""), json.find("\"ph\":\"E\""));
+	Tracer::Clear();
+	Tracer::Enable(false);
+}
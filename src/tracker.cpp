@@ -0,0 +1,49 @@
+/*
+ * Copyright 2014 Samuel de Sousa
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include <tracker.hpp>
+
+#include <vector>
+
+#include <glog/logging.h>
+
+namespace n1graph {
+
+Tracker::Tracker(float threshold) :
+		threshold_(threshold), warm_frames_(0), full_frames_(0) {
+	CHECK_GE(threshold, 0);
+}
+
+Tracker::~Tracker() {
+}
+
+const N1Graph& Tracker::Update(const AdjacencyGraph& frame) {
+	if (graph_.nodes().size() != frame.NumberOfNodes()) {
+		graph_.Minimize(frame);
+		full_frames_++;
+		return graph_;
+	}
+	// Minimize overwrites the solution, hence the copy.
+	std::vector<int> incumbent = graph_.nodes();
+	if (graph_.Minimize(frame, incumbent, graph_.cost(), threshold_))
+		warm_frames_++;
+	else
+		full_frames_++;
+	return graph_;
+}
+
+} /* namespace n1graph */
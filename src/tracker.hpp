@@ -0,0 +1,77 @@
+/*
+ * Copyright 2014 Samuel de Sousa
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#ifndef TRACKER_HPP_
+#define TRACKER_HPP_
+
+#include <adjacency_graph.hpp>
+#include <n1graph.hpp>
+
+namespace n1graph {
+
+/**
+ * Computes the G_N graph of consecutive frames of a moving point-set. Each
+ * frame is warm-started from the solution of the previous one, and a full
+ * search is only run when the cost changed more than the threshold.
+ */
+class Tracker {
+public:
+	/**
+	 * @param threshold: The allowed relative change of the cost between two
+	 * frames before a full search is required, e.g. 0.05 for 5%.
+	 */
+	explicit Tracker(float threshold);
+
+	/**
+	 * Computes the G_N graph of the next frame. The first frame, or a frame
+	 * whose number of points differs from the previous one, is fully
+	 * minimized.
+	 *
+	 * @param frame: The complete graph of the point-set.
+	 * @return the G_N graph of the frame.
+	 */
+	const N1Graph& Update(const AdjacencyGraph& frame);
+
+	const N1Graph& graph() const {
+		return graph_;
+	}
+
+	/**
+	 * Returns the number of frames solved from the previous solution.
+	 */
+	int warm_frames() const {
+		return warm_frames_;
+	}
+
+	/**
+	 * Returns the number of frames which required a full search.
+	 */
+	int full_frames() const {
+		return full_frames_;
+	}
+
+	virtual ~Tracker();
+
+private:
+	float threshold_;
+	N1Graph graph_;
+	int warm_frames_;
+	int full_frames_;
+};
+
+} /* namespace n1graph */
+#endif /* TRACKER_HPP_ */
@@ -0,0 +1,88 @@
+/*
+ * Copyright 2014 Samuel de Sousa
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ * 
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ * 
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "gtest/gtest.h"
+
+#include <vector>
+
+#include <generator.hpp>
+#include <n1graph.hpp>
+#include <tracker.hpp>
+
+using namespace n1graph;
+
+namespace {
+
+// The points shifted by a small motion which depends on the frame.
+std::vector<Vector<float> > Frame(const std::vector<Vector<float> >& points,
+		int frame) {
+	std::vector<Vector<float> > moved = points;
+	for (int i = 0; i < static_cast<int>(moved.size()); ++i)
+		moved[i] = moved[i] + Vector<float>(0.01f * frame * (i % 3), 0.f);
+	return moved;
+}
+
+}  // namespace
+
+TEST(TrackerTest, WarmStartsConsecutiveFrames) {
+	std::vector<Vector<float> > points = Generator::Uniform(16, 100.f, 300);
+	Tracker tracker(0.05f);
+	for (int frame = 0; frame < 5; ++frame) {
+		AdjacencyGraph input = Generator::EuclideanGraph(Frame(points, frame));
+		const N1Graph& graph = tracker.Update(input);
+		EXPECT_EQ(graph.cost(), N1Graph::Evaluate(input, graph.nodes()));
+	}
+	EXPECT_EQ(tracker.full_frames(), 1);
+	EXPECT_EQ(tracker.warm_frames(), 4);
+}
+
+TEST(TrackerTest, FullySolvesAChangeOfPointCount) {
+	Tracker tracker(0.05f);
+	tracker.Update(Generator::EuclideanGraph(
+			Generator::Uniform(12, 100.f, 301)));
+	AdjacencyGraph input = Generator::EuclideanGraph(
+			Generator::Uniform(14, 100.f, 302));
+	const N1Graph& graph = tracker.Update(input);
+	EXPECT_EQ(tracker.full_frames(), 2);
+	EXPECT_EQ(tracker.warm_frames(), 0);
+	N1Graph cold;
+	cold.Minimize(input);
+	EXPECT_EQ(graph.nodes(), cold.nodes());
+	EXPECT_EQ(graph.cost(), cold.cost());
+}
+
+TEST(TrackerTest, FallsBackWhenTheCostChanges) {
+	Tracker tracker(0.f);
+	tracker.Update(Generator::EuclideanGraph(
+			Generator::Uniform(12, 100.f, 303)));
+	// Another point-set of the same size, i.e. the cost changes.
+	AdjacencyGraph input = Generator::EuclideanGraph(
+			Generator::Uniform(12, 10.f, 304));
+	std::vector<int> incumbent = tracker.graph().nodes();
+	const N1Graph& graph = tracker.Update(input);
+	EXPECT_EQ(tracker.full_frames(), 2);
+	EXPECT_EQ(tracker.warm_frames(), 0);
+	// The full search, unless the previous order is strictly cheaper.
+	N1Graph cold;
+	cold.Minimize(input);
+	if (N1Graph::Evaluate(input, incumbent) < cold.cost()) {
+		EXPECT_EQ(graph.nodes(), incumbent);
+	} else {
+		EXPECT_EQ(graph.nodes(), cold.nodes());
+		EXPECT_EQ(graph.cost(), cold.cost());
+	}
+}
@@ -24,33 +24,38 @@
 namespace n1graph {
 
 template<class T>
-Vector<T>::Vector(const Vector<T>& v1) {
+Vector<T>::Vector(const Vector<T>& v1) :
+		accounted_(false) {
 	if (&v1 != this) {
 		length_ = v1.length();
 		data_.reset(new T[v1.length_]);
 		memcpy(data_.get(), v1.data(), length_ * sizeof(T));
+		Account();
 	}
 }
 
 template<class T>
 Vector<T>::Vector(T dim0) :
-		length_(1) {
+		length_(1), accounted_(false) {
 	data_.reset(new T[length_]);
+	Account();
 	data_[0] = dim0;
 }
 
 template<class T>
 Vector<T>::Vector(T dim0, T dim1) :
-		length_(2) {
+		length_(2), accounted_(false) {
 	data_.reset(new T[length_]);
+	Account();
 	data_[0] = dim0;
 	data_[1] = dim1;
 }
 
 template<class T>
 Vector<T>::Vector(T dim0, T dim1, T dim2) :
-		length_(3) {
+		length_(3), accounted_(false) {
 	data_.reset(new T[length_]);
+	Account();
 	data_[0] = dim0;
 	data_[1] = dim1;
 	data_[2] = dim2;
@@ -58,8 +63,9 @@ Vector<T>::Vector(T dim0, T dim1, T dim2) :
 
 template<class T>
 Vector<T>::Vector(T dim0, T dim1, T dim2, T dim3) :
-		length_(4) {
+		length_(4), accounted_(false) {
 	data_.reset(new T[length_]);
+	Account();
 	data_[0] = dim0;
 	data_[1] = dim1;
 	data_[2] = dim2;
@@ -68,8 +74,10 @@ Vector<T>::Vector(T dim0, T dim1, T dim2, T dim3) :
 
 template<class T>
 void Vector<T>::Resize(int length) {
+	Unaccount();
 	length_ = length;
 	data_.reset(new T[length_]);
+	Account();
 }
 
 template<class T>
@@ -95,22 +103,24 @@ Vector<T> Vector<T>::operator +(const Vector<T>& v1) const {
 template<class T>
 Vector<T>& Vector<T>::operator =(const Vector<T>& v1) {
 	if (this != &v1) {
+		Unaccount();
 		length_ = v1.length();
 		data_.reset(new T[v1.length_]);
 		memcpy(data_.get(), v1.data(), length_ * sizeof(T));
+		Account();
 	}
 	return *this;
 }
 
 template<class T>
 T& Vector<T>::operator [](int dim) {
-	CHECK_LT(dim, length_);
+	DCHECK_LT(dim, length_);
 	return data_[dim];
 }
 
 template<class T>
 const T& Vector<T>::operator [](int dim) const {
-	CHECK_LT(dim, length_);
+	DCHECK_LT(dim, length_);
 	return data_[dim];
 }
 
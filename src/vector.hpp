@@ -22,13 +22,15 @@
 #include <memory>
 #include <string>
 
+#include <memory.hpp>
+
 namespace n1graph {
 
 template<class T>
 class Vector {
 public:
 	Vector() :
-			length_(0) {
+			length_(0), accounted_(false) {
 
 	}
 
@@ -61,6 +63,7 @@ public:
 		return output;
 	}
 	virtual ~Vector() {
+		Unaccount();
 	}
 
 	int length() const {
@@ -68,7 +71,22 @@ public:
 	}
 
 private:
+	// Accounts the current storage in Memory.
+	void Account() {
+		accounted_ = Memory::Allocate(MemorySubsystem::VECTOR,
+				length_ * sizeof(T));
+	}
+
+	// Releases the accounting of the current storage.
+	void Unaccount() {
+		if (accounted_)
+			Memory::Release(MemorySubsystem::VECTOR, length_ * sizeof(T));
+		accounted_ = false;
+	}
+
 	int length_;
+	// Whether the storage has been accounted in Memory.
+	bool accounted_;
 	std::unique_ptr<T[]> data_;
 
 };
@@ -18,9 +18,9 @@
 
 #include <cmath>
 
-#include <core/vector.hpp>
+#include <vector.hpp>
 
-using namespace n1graph::core;
+using namespace n1graph;
 
 TEST(VectorTest, CreationTest) {
 	Vector<int> vec1(10, 10);